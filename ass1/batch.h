@@ -0,0 +1,33 @@
+#ifndef BATCH
+#define BATCH
+
+#include <stdint.h>
+#include "types.h"
+
+/**
+ * Many boards of the same size, stored interleaved (structure of arrays):
+ * the entries for one interior cell of every board sit next to each other,
+ * so each evaluation loop runs across the boards and can be vectorised.
+ * Entry [cell * count + k] belongs to board k.
+ */
+typedef struct BoardBatch {
+
+    int height; // height of every board
+    int width; // width of every board
+    int count; // the number of boards
+    int numCells; // the number of interior cells in each board
+    uint8_t* values; // the value of each interior cell
+    uint8_t* naughts; // 1 if the cell holds an O, otherwise 0
+    uint8_t* crosses; // 1 if the cell holds an X, otherwise 0
+    uint8_t* empties; // 1 if the cell is empty, otherwise 0
+    int* naughtScores; // O's score on each board, set by batch_evaluate
+    int* crossScores; // X's score on each board, set by batch_evaluate
+    uint8_t* gameOver; // 1 if board k is full, set by batch_evaluate
+} BoardBatch;
+
+void batch_init(BoardBatch* batch, int height, int width, int count);
+void batch_set_board(BoardBatch* batch, int index, Board* board);
+void batch_evaluate(BoardBatch* batch);
+void batch_free(BoardBatch* batch);
+
+#endif
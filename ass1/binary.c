@@ -0,0 +1,170 @@
+/**
+ * This file handles the compact binary savefile format: a 4 byte magic
+ * number, the height and width (4 bytes each, little endian), a byte for
+ * whose turn it is, then one byte per cell. A cell's low 4 bits are its
+ * value (0 - 9, or 15 for a corner's blank value) and the next 2 bits its
+ * symbol. It holds exactly what a text savefile holds in about half the
+ * space, and never needs parsing.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "types.h"
+#include "utility.h"
+#include "load.h"
+#include "binary.h"
+
+#define BINARY_MAGIC "P2B1"
+#define MAGIC_LENGTH 4
+#define BLANK_VALUE 15 // the value code for a ' ' value (corners)
+#define MIN_DIMENSION 3
+
+static const char symbols[] = ".OX "; // symbol codes 0 to 3
+
+/**
+ * Checks if a file starts with the binary magic number. The file is left
+ * at the start either way.
+ * @param file the file to check
+ * @returns true if it's a binary savefile
+ */
+bool is_binary_savefile(FILE* file) {
+
+    char magic[MAGIC_LENGTH];
+    bool binary = fread(magic, 1, MAGIC_LENGTH, file) == MAGIC_LENGTH
+            && memcmp(magic, BINARY_MAGIC, MAGIC_LENGTH) == 0;
+
+    rewind(file);
+    return binary;
+}
+
+/**
+ * Writes a 32 bit number, little endian
+ * @param file the file to write to
+ * @param value the number
+ */
+void write_uint32(FILE* file, uint32_t value) {
+
+    for (int i = 0; i < 4; i++) {
+        putc((value >> (8 * i)) & 0xFF, file);
+    }
+}
+
+/**
+ * Reads a 32 bit number, little endian
+ * @param file the file to read from
+ * @param value where to put the number
+ * @returns false at the end of the file
+ */
+bool read_uint32(FILE* file, uint32_t* value) {
+
+    unsigned char bytes[4];
+
+    if (fread(bytes, 1, 4, file) != 4) {
+        return false;
+    }
+
+    *value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16)
+            | ((uint32_t) bytes[3] << 24);
+    return true;
+}
+
+/**
+ * Writes a board in the binary format
+ * @param file the file to write to
+ * @param board the board
+ * @param playerTurn whose turn it is
+ * @returns false if a cell can't be stored (its value isn't a digit or a
+ * blank, or its symbol isn't '.', 'O', 'X' or ' ')
+ */
+bool write_binary_savefile(FILE* file, Board* board, PlayerTurn playerTurn) {
+
+    fwrite(BINARY_MAGIC, 1, MAGIC_LENGTH, file);
+    write_uint32(file, board->height);
+    write_uint32(file, board->width);
+    putc(playerTurn, file);
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            char value = board->values[i][j][0];
+            char* symbol = strchr(symbols, board->values[i][j][1]);
+            if (symbol == NULL || *symbol == '\0'
+                    || ((value < '0' || value > '9') && value != ' ')) {
+                return false;
+            }
+            int valueCode = (value == ' ') ? BLANK_VALUE : value - '0';
+            putc(valueCode | ((symbol - symbols) << 4), file);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Reads a binary savefile, checking it the same way read_savefile checks
+ * text savefiles
+ * @param file the savefile, opened for reading
+ * @param board where to put the board, its values are allocated if LOAD_OK
+ * @param playerTurn where to put whose turn it is
+ * @param maxCells the most cells a board may have, or 0 for no limit
+ * @returns LOAD_OK, or the reason the savefile is invalid
+ */
+LoadStatus read_binary_savefile(FILE* file, Board* board,
+        PlayerTurn* playerTurn, long maxCells) {
+
+    char magic[MAGIC_LENGTH];
+    uint32_t height;
+    uint32_t width;
+
+    if (fread(magic, 1, MAGIC_LENGTH, file) != MAGIC_LENGTH
+            || !read_uint32(file, &height) || !read_uint32(file, &width)
+            || height < MIN_DIMENSION || width < MIN_DIMENSION
+            || height > INT32_MAX || width > INT32_MAX) {
+        return LOAD_BAD_DIMENSIONS;
+    }
+    if (maxCells > 0 && (double) height * width > maxCells) {
+        return LOAD_TOO_LARGE;
+    }
+
+    int turn = getc(file);
+    if (turn != PLAYER_O_TURN && turn != PLAYER_X_TURN) {
+        return LOAD_BAD_TURN;
+    }
+    *playerTurn = turn;
+
+    board->height = height;
+    board->width = width;
+    board->values = allocate_board_memory(height, width);
+    board->emptyInRow = NULL;
+    board->emptyInCol = NULL;
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            int cell = getc(file);
+            int valueCode = cell & 0x0F;
+            if (cell == EOF) {
+                free_board(board);
+                return LOAD_SHORT_ROW;
+            }
+            if ((cell >> 6) != 0
+                    || (valueCode > 9 && valueCode != BLANK_VALUE)) {
+                free_board(board);
+                return LOAD_BAD_CELL;
+            }
+            board->values[i][j][0] = (valueCode == BLANK_VALUE)
+                    ? ' ' : '0' + valueCode;
+            board->values[i][j][1] = symbols[cell >> 4];
+            board->values[i][j][2] = '\0';
+        }
+    }
+
+    if (check_full_load(board->values, board->height, board->width)) {
+        free_board(board);
+        return LOAD_FULL_BOARD;
+    }
+
+    count_empty_cells(board);
+    return LOAD_OK;
+}
@@ -0,0 +1,14 @@
+#ifndef BINARY
+#define BINARY
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "types.h"
+#include "load.h"
+
+bool is_binary_savefile(FILE* file);
+bool write_binary_savefile(FILE* file, Board* board, PlayerTurn playerTurn);
+LoadStatus read_binary_savefile(FILE* file, Board* board,
+        PlayerTurn* playerTurn, long maxCells);
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * This file handles opening books: files of the moves computer players
+ * make in positions reached early in self-play from standard savefiles
+ * (written by push2310-book). A book is mmap'd read only, so it costs
+ * nothing until a position is looked up, and any number of processes can
+ * share it.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "types.h"
+#include "book.h"
+
+#define BOOK_VARIABLE "PUSH2310_BOOK" // env var with the book's file name
+#define BOOK_MAGIC 0x4b4f4f4230313332ULL // "2310BOOK" in little endian
+#define TYPE_MIX 0x9e3779b97f4a7c15ULL // spreads the type over the key
+
+/**
+ * The start of a book file
+ */
+typedef struct BookHeader {
+
+    uint64_t magic; // BOOK_MAGIC
+    uint64_t numEntries; // how many entries follow the header
+} BookHeader;
+
+static BookHeader* book = NULL; // the mapped file, NULL if not in use
+static BookEntry* bookEntries = NULL; // the entries after the header
+static size_t bookBytes = 0; // the size of the mapping
+
+/**
+ * Works out the key a move is stored under. Computer zero and computer one
+ * move differently in the same position, so the type is part of the key.
+ * @param positionHash hash_board of the position
+ * @param type the type of computer player to move
+ * @returns the key
+ */
+uint64_t book_key(uint64_t positionHash, PlayerType type) {
+
+    return positionHash ^ ((uint64_t) (type + 1) * TYPE_MIX);
+}
+
+/**
+ * Maps the book file named by PUSH2310_BOOK. If the variable isn't set or
+ * the file isn't a valid book, no book is used.
+ */
+void open_book(void) {
+
+    char* fileName = getenv(BOOK_VARIABLE);
+    if (fileName == NULL || fileName[0] == '\0') {
+        return;
+    }
+
+    int fd = open(fileName, O_RDONLY);
+    if (fd == -1) {
+        return;
+    }
+
+    struct stat info;
+    BookHeader header;
+    if (fstat(fd, &info) != 0
+            || pread(fd, &header, sizeof(header), 0) != sizeof(header)
+            || header.magic != BOOK_MAGIC
+            || (uint64_t) info.st_size != sizeof(BookHeader)
+            + header.numEntries * sizeof(BookEntry)) {
+        close(fd);
+        return;
+    }
+
+    bookBytes = info.st_size;
+    void* mapping = mmap(NULL, bookBytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // the mapping stays valid after closing
+
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+
+    book = (BookHeader*) mapping;
+    bookEntries = (BookEntry*) (book + 1);
+}
+
+/**
+ * Unmaps the book, if one was opened
+ */
+void close_book(void) {
+
+    if (book != NULL) {
+        munmap(book, bookBytes);
+        book = NULL;
+        bookEntries = NULL;
+    }
+}
+
+/**
+ * Checks if a book was opened, so callers can skip hashing the board
+ * @returns true iff there is a book to probe
+ */
+bool book_in_use(void) {
+
+    return book != NULL;
+}
+
+/**
+ * Looks up a position in the book
+ * @param key book_key of the position and the computer type to move
+ * @param coords set to the book move if the position was found
+ * @returns true iff the position was in the book
+ */
+bool probe_book(uint64_t key, Coordinates* coords) {
+
+    if (book == NULL) {
+        return false;
+    }
+
+    size_t low = 0;
+    size_t high = book->numEntries;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (bookEntries[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    if (low == book->numEntries || bookEntries[low].key != key) {
+        return false;
+    }
+
+    coords->row = bookEntries[low].row;
+    coords->column = bookEntries[low].column;
+    return true;
+}
+
+/**
+ * Orders book entries by key, for qsort
+ * @param first the first BookEntry
+ * @param second the second BookEntry
+ * @returns negative, zero or positive like strcmp
+ */
+int compare_book_entries(const void* first, const void* second) {
+
+    uint64_t firstKey = ((const BookEntry*) first)->key;
+    uint64_t secondKey = ((const BookEntry*) second)->key;
+
+    return (firstKey > secondKey) - (firstKey < secondKey);
+}
+
+/**
+ * Writes a book file. The entries are sorted, and a position that turns up
+ * more than once (from different games) is only kept once.
+ * @param fileName the file to write
+ * @param entries the moves, which get sorted in place
+ * @param numEntries the number of moves
+ * @returns false if the file couldn't be written
+ */
+bool write_book(char* fileName, BookEntry* entries, size_t numEntries) {
+
+    size_t numUnique = 0;
+
+    qsort(entries, numEntries, sizeof(BookEntry), compare_book_entries);
+    for (size_t i = 0; i < numEntries; i++) {
+        if (numUnique == 0 || entries[i].key != entries[numUnique - 1].key) {
+            entries[numUnique++] = entries[i];
+        }
+    }
+
+    FILE* file = fopen(fileName, "wb");
+    if (file == NULL) {
+        return false;
+    }
+
+    BookHeader header = {BOOK_MAGIC, numUnique};
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+            && fwrite(entries, sizeof(BookEntry), numUnique, file)
+            == numUnique;
+
+    return (fclose(file) == 0) && written;
+}
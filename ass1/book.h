@@ -0,0 +1,27 @@
+#ifndef BOOK
+#define BOOK
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "types.h"
+
+/**
+ * One move in an opening book file. The file is a BookHeader followed by
+ * the entries sorted by key, so lookups are a binary search of the mapping.
+ */
+typedef struct BookEntry {
+
+    uint64_t key; // book_key of the position and computer type
+    int32_t row;
+    int32_t column;
+} BookEntry;
+
+uint64_t book_key(uint64_t positionHash, PlayerType type);
+void open_book(void);
+void close_book(void);
+bool book_in_use(void);
+bool probe_book(uint64_t key, Coordinates* coords);
+bool write_book(char* fileName, BookEntry* entries, size_t numEntries);
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * push2310-book builds an opening book: it plays every combination of
+ * computer players against each other from each of the given savefiles,
+ * in parallel, and records the move made in every position for the first
+ * few turns. push2310 then looks those moves up instead of working them
+ * out (see book.c).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "types.h"
+#include "utility.h"
+#include "load.h"
+#include "computer.h"
+#include "parallel.h"
+#include "engine.h"
+#include "book.h"
+
+#define DEFAULT_BOOK_PLIES 16 // how many moves of each game go in the book
+#define DEFAULT_BOOK_THREADS 4
+#define NUM_LINEUPS 4 // 00, 01, 10 and 11
+
+/**
+ * Settings and shared state for building a book
+ */
+typedef struct BookBuild {
+
+    char** rootFiles; // the savefiles to play from
+    int numRoots;
+    int plies; // the most moves to record per game
+    pthread_mutex_t lock; // protects everything below
+    int nextGame; // the next root and lineup to play, root * 4 + lineup
+    BookEntry* entries; // every move recorded so far
+    size_t numEntries;
+    size_t capacity;
+    bool failed; // a savefile was invalid
+} BookBuild;
+
+/**
+ * Exit thrown when push2310-book is given bad arguments
+ */
+void exit_book_usage(void) {
+
+    fprintf(stderr, "%s", "Usage: push2310-book [-j threads] [-d plies] "
+            "-o bookfile savefile...\n");
+    exit(1);
+}
+
+/**
+ * Adds one game's moves to the book
+ * @param build the book being built
+ * @param moves the moves
+ * @param numMoves how many moves there are
+ */
+void add_book_moves(BookBuild* build, BookEntry* moves, int numMoves) {
+
+    pthread_mutex_lock(&build->lock);
+    if (build->numEntries + numMoves > build->capacity) {
+        build->capacity = build->capacity * 2 + numMoves;
+        build->entries = realloc(build->entries,
+                build->capacity * sizeof(BookEntry));
+        check_allocated_memory(build->entries);
+    }
+    memcpy(build->entries + build->numEntries, moves,
+            numMoves * sizeof(BookEntry));
+    build->numEntries += numMoves;
+    pthread_mutex_unlock(&build->lock);
+}
+
+/**
+ * Plays the first moves of one game from a savefile, recording each
+ * computer move against the position it was made in
+ * @param build the book being built
+ * @param root index of the savefile to play from
+ * @param lineup bit 1 is player O's computer type, bit 0 is player X's
+ * @param moves room for build->plies moves
+ */
+void play_book_game(BookBuild* build, int root, int lineup,
+        BookEntry* moves) {
+
+    PlayerType types[2] = {(lineup >> 1) & 1, lineup & 1};
+    PlayerTurn playerTurn;
+    Board board;
+    int numMoves = 0;
+    FILE* file = fopen(build->rootFiles[root], "r");
+    LoadStatus status = (file == NULL) ? LOAD_BAD_DIMENSIONS
+            : read_savefile(file, &board, &playerTurn, 0);
+
+    if (file != NULL) {
+        fclose(file);
+    }
+    if (status != LOAD_OK) {
+        if (lineup == 0) {
+            fprintf(stderr, "%s: %s\n", build->rootFiles[root], (file == NULL)
+                    ? "can't open" : load_status_message(status));
+        }
+        pthread_mutex_lock(&build->lock);
+        build->failed = true;
+        pthread_mutex_unlock(&build->lock);
+        return;
+    }
+
+    Engine engine = select_engine(&board);
+    bool gameOver = false;
+    while (!gameOver && numMoves < build->plies) {
+        PlayerType type = types[playerTurn];
+        uint64_t key = book_key(hash_board(&board, playerTurn), type);
+        Coordinates move = get_computer_input(&board, playerTurn, type);
+
+        moves[numMoves].key = key;
+        moves[numMoves].row = move.row;
+        moves[numMoves].column = move.column;
+        numMoves++;
+
+        engine.play(engine.state, playerTurn, move);
+        engine.sync(engine.state, &board);
+        playerTurn ^= 1;
+        gameOver = engine.game_over(engine.state);
+    }
+
+    add_book_moves(build, moves, numMoves);
+    free_engine(&engine);
+    free_board(&board);
+}
+
+/**
+ * Worker thread; plays games until there are none left
+ * @param arg the BookBuild
+ * @returns NULL
+ */
+void* book_worker(void* arg) {
+
+    BookBuild* build = arg;
+    BookEntry* moves = malloc(build->plies * sizeof(BookEntry));
+    check_allocated_memory(moves);
+
+    while (true) {
+        pthread_mutex_lock(&build->lock);
+        int game = build->nextGame++;
+        pthread_mutex_unlock(&build->lock);
+
+        if (game >= build->numRoots * NUM_LINEUPS) {
+            break;
+        }
+        play_book_game(build, game / NUM_LINEUPS, game % NUM_LINEUPS, moves);
+    }
+
+    free(moves);
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+
+    BookBuild build;
+    char* bookFile = NULL;
+    int numThreads = DEFAULT_BOOK_THREADS;
+    int option;
+
+    build.plies = DEFAULT_BOOK_PLIES;
+    while ((option = getopt(argc, argv, "j:d:o:")) != -1) {
+        switch (option) {
+            case 'j':
+                numThreads = atoi(optarg);
+                break;
+            case 'd':
+                build.plies = atoi(optarg);
+                break;
+            case 'o':
+                bookFile = optarg;
+                break;
+            default:
+                exit_book_usage();
+        }
+    }
+    if (bookFile == NULL || optind == argc || numThreads < 1
+            || build.plies < 1) {
+        exit_book_usage();
+    }
+
+    build.rootFiles = argv + optind;
+    build.numRoots = argc - optind;
+    pthread_mutex_init(&build.lock, NULL);
+    build.nextGame = 0;
+    build.entries = NULL;
+    build.numEntries = 0;
+    build.capacity = 0;
+    build.failed = false;
+
+    get_computer_threads(); // read the environment before workers start
+    pthread_t* threads = malloc(numThreads * sizeof(pthread_t));
+    check_allocated_memory(threads);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_create(&threads[i], NULL, book_worker, &build);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    if (!write_book(bookFile, build.entries, build.numEntries)) {
+        fprintf(stderr, "Can't write %s\n", bookFile);
+        exit(2);
+    }
+
+    free(build.entries);
+    pthread_mutex_destroy(&build.lock);
+    return build.failed ? 3 : 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * push2310-check validates savefiles in bulk, without starting a game for
+ * each one. It takes any mix of savefiles and directories (which are
+ * searched recursively), checks every file on a pool of threads using the
+ * same rules as push2310's loader, and reports each invalid file with the
+ * reason. Given -o it also writes every valid file out again, normalised
+ * (or converted to the binary format with -f binary), keeping the layout
+ * of the directories it came from.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "types.h"
+#include "utility.h"
+#include "load.h"
+#include "binary.h"
+
+#define DEFAULT_CHECK_THREADS 4
+#define MAX_CHECK_CELLS 100000000L // larger boards are reported, not loaded
+
+/**
+ * A savefile to check
+ */
+typedef struct CheckFile {
+
+    char* path; // where to read it from
+    char* relative; // where to write it, relative to the output directory
+    const char* problem; // NULL if the file is valid
+} CheckFile;
+
+/**
+ * Settings and shared state for a run of the checker
+ */
+typedef struct Check {
+
+    CheckFile* files;
+    int numFiles;
+    int capacity;
+    char* outputDir; // where to write normalised files, NULL to not write
+    bool binary; // write the binary format instead of text
+    pthread_mutex_t lock; // protects nextFile
+    int nextFile; // the next file for a worker to check
+} Check;
+
+/**
+ * Exit thrown when the checker is given bad arguments
+ */
+void exit_check_usage(void) {
+
+    fprintf(stderr, "%s", "Usage: push2310-check [-j threads] "
+            "[-f text|binary] [-o outdir] path...\n");
+    exit(1);
+}
+
+/**
+ * Joins two parts of a path with a '/'
+ * @param first the first part
+ * @param second the second part
+ * @returns the joined path, which must be freed
+ */
+char* join_path(const char* first, const char* second) {
+
+    char* path = malloc(strlen(first) + strlen(second) + 2);
+    check_allocated_memory(path);
+    sprintf(path, "%s/%s", first, second);
+    return path;
+}
+
+/**
+ * Adds a file to the list to be checked
+ * @param check the checker state
+ * @param path where the file is
+ * @param relative where it goes under the output directory
+ */
+void add_check_file(Check* check, char* path, char* relative) {
+
+    if (check->numFiles == check->capacity) {
+        check->capacity = check->capacity * 2 + 64;
+        check->files = realloc(check->files,
+                sizeof(CheckFile) * check->capacity);
+        check_allocated_memory(check->files);
+    }
+
+    CheckFile* file = &check->files[check->numFiles++];
+    file->path = path;
+    file->relative = relative;
+    file->problem = NULL;
+}
+
+/**
+ * Orders strings for qsort
+ * @param first pointer to the first string
+ * @param second pointer to the second string
+ * @returns what strcmp returns
+ */
+int compare_names(const void* first, const void* second) {
+
+    return strcmp(*(char* const*) first, *(char* const*) second);
+}
+
+/**
+ * Adds a savefile, or every file under a directory (in name order, so the
+ * report always comes out in the same order). Symbolic links to
+ * directories inside a directory aren't followed.
+ * @param check the checker state
+ * @param path the file or directory, which the list takes ownership of
+ * @param relative its path under the output directory, also taken
+ */
+void find_check_files(Check* check, char* path, char* relative) {
+
+    struct stat info;
+    if (stat(path, &info) != 0 || !S_ISDIR(info.st_mode)) {
+        add_check_file(check, path, relative); // problems show up on open
+        return;
+    }
+
+    DIR* directory = opendir(path);
+    if (directory == NULL) {
+        add_check_file(check, path, relative);
+        return;
+    }
+
+    char** names = NULL;
+    int numNames = 0;
+    struct dirent* entry;
+    while ((entry = readdir(directory)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0
+                || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+        names = realloc(names, sizeof(char*) * (numNames + 1));
+        check_allocated_memory(names);
+        names[numNames] = malloc(strlen(entry->d_name) + 1);
+        check_allocated_memory(names[numNames]);
+        strcpy(names[numNames++], entry->d_name);
+    }
+    closedir(directory);
+
+    qsort(names, numNames, sizeof(char*), compare_names);
+    for (int i = 0; i < numNames; i++) {
+        char* child = join_path(path, names[i]);
+        if (lstat(child, &info) == 0 && S_ISLNK(info.st_mode)
+                && stat(child, &info) == 0 && S_ISDIR(info.st_mode)) {
+            free(child); // could lead back up the tree (ln -s .. loop)
+        } else {
+            find_check_files(check, child, join_path(relative, names[i]));
+        }
+        free(names[i]);
+    }
+
+    free(names);
+    free(path);
+    free(relative);
+}
+
+/**
+ * Creates every directory leading up to a file
+ * @param path the file's path
+ */
+void make_parent_directories(char* path) {
+
+    for (char* slash = strchr(path + 1, '/'); slash != NULL;
+            slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(path, 0777); // failing because it exists is fine
+        *slash = '/';
+    }
+}
+
+/**
+ * Writes a valid board back out, normalised, under the output directory
+ * @param check the checker state
+ * @param file the savefile it came from
+ * @param board the board
+ * @param playerTurn whose turn it is
+ * @returns NULL, or what went wrong
+ */
+const char* write_check_file(Check* check, CheckFile* file, Board* board,
+        PlayerTurn playerTurn) {
+
+    char* path = join_path(check->outputDir, file->relative);
+    make_parent_directories(path);
+
+    FILE* output = fopen(path, "w");
+    if (output == NULL) {
+        free(path);
+        return "can't write output";
+    }
+
+    bool converted = true;
+    if (check->binary) {
+        converted = write_binary_savefile(output, board, playerTurn);
+    } else {
+        write_savefile(output, board, playerTurn);
+    }
+
+    bool closed = (fclose(output) == 0);
+    if (!closed || !converted) {
+        unlink(path); // don't leave half written files behind
+    }
+    free(path);
+
+    if (!closed) {
+        return "can't write output";
+    }
+    return converted ? NULL : "cells can't be stored in the binary format";
+}
+
+/**
+ * Checks one savefile (text or binary), and writes it out if asked to
+ * @param check the checker state
+ * @param file the savefile
+ */
+void check_savefile(Check* check, CheckFile* file) {
+
+    Board board;
+    PlayerTurn playerTurn;
+    FILE* input = fopen(file->path, "rb");
+
+    if (input == NULL) {
+        file->problem = "can't open";
+        return;
+    }
+
+    LoadStatus status = is_binary_savefile(input)
+            ? read_binary_savefile(input, &board, &playerTurn,
+                    MAX_CHECK_CELLS)
+            : read_savefile(input, &board, &playerTurn,
+                    MAX_CHECK_CELLS);
+    fclose(input);
+
+    if (status != LOAD_OK) {
+        file->problem = load_status_message(status);
+        return;
+    }
+
+    if (check->outputDir != NULL) {
+        file->problem = write_check_file(check, file, &board, playerTurn);
+    }
+
+    free_board(&board);
+}
+
+/**
+ * Worker thread; checks files until there are none left
+ * @param arg the Check
+ * @returns NULL
+ */
+void* check_worker(void* arg) {
+
+    Check* check = arg;
+
+    while (true) {
+        pthread_mutex_lock(&check->lock);
+        int index = check->nextFile++;
+        pthread_mutex_unlock(&check->lock);
+
+        if (index >= check->numFiles) {
+            return NULL;
+        }
+        check_savefile(check, &check->files[index]);
+    }
+}
+
+/**
+ * Gets the last part of a path, the name an argument's file is written
+ * under in the output directory
+ * @param path the path
+ * @returns a copy of its last part, which must be freed
+ */
+char* path_name(char* path) {
+
+    size_t length = strlen(path);
+    while (length > 1 && path[length - 1] == '/') {
+        length--; // ignore trailing slashes
+    }
+
+    size_t start = length;
+    while (start > 0 && path[start - 1] != '/') {
+        start--;
+    }
+
+    char* name = malloc(length - start + 1);
+    check_allocated_memory(name);
+    memcpy(name, path + start, length - start);
+    name[length - start] = '\0';
+    return name;
+}
+
+int main(int argc, char** argv) {
+
+    Check check;
+    int numThreads = DEFAULT_CHECK_THREADS;
+    int option;
+
+    memset(&check, 0, sizeof(check));
+    while ((option = getopt(argc, argv, "j:f:o:")) != -1) {
+        switch (option) {
+            case 'j':
+                numThreads = atoi(optarg);
+                break;
+            case 'f':
+                if (strcmp(optarg, "binary") != 0
+                        && strcmp(optarg, "text") != 0) {
+                    exit_check_usage();
+                }
+                check.binary = (strcmp(optarg, "binary") == 0);
+                break;
+            case 'o':
+                check.outputDir = optarg;
+                break;
+            default:
+                exit_check_usage();
+        }
+    }
+    if (optind == argc || numThreads < 1) {
+        exit_check_usage();
+    }
+
+    for (int i = optind; i < argc; i++) {
+        char* path = malloc(strlen(argv[i]) + 1);
+        check_allocated_memory(path);
+        strcpy(path, argv[i]);
+        find_check_files(&check, path, path_name(argv[i]));
+    }
+
+    pthread_mutex_init(&check.lock, NULL);
+    pthread_t* threads = malloc(sizeof(pthread_t) * numThreads);
+    check_allocated_memory(threads);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_create(&threads[i], NULL, check_worker, &check);
+    }
+    for (int i = 0; i < numThreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&check.lock);
+
+    int numInvalid = 0;
+    for (int i = 0; i < check.numFiles; i++) {
+        if (check.files[i].problem != NULL) {
+            printf("%s: %s\n", check.files[i].path, check.files[i].problem);
+            numInvalid++;
+        }
+        free(check.files[i].path);
+        free(check.files[i].relative);
+    }
+    fprintf(stderr, "%d files checked, %d invalid\n", check.numFiles,
+            numInvalid);
+
+    free(check.files);
+    return (numInvalid == 0) ? 0 : 3;
+}
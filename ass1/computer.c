@@ -6,6 +6,10 @@
 #include "types.h"
 #include "graphics.h"
 #include "logic.h"
+#include "parallel.h"
+#include "table.h"
+#include "book.h"
+#include "utility.h"
 
 /**
  * Works out where computer zero would want to place
@@ -57,7 +61,12 @@ Coordinates get_computer_one_input(Board* board, PlayerTurn player) {
     coords.column = -1;
     
     // check edges and see if point lowers score... 
-    coords = find_lower_score(board, player);
+    int numThreads = get_computer_threads();
+    if (numThreads > 1) {
+        coords = find_lower_score_parallel(board, player, numThreads);
+    } else {
+        coords = find_lower_score(board, player);
+    }
 
     if (coords.row == -1 || coords.column == -1) {
         // nothing was found, try find highest value
@@ -78,5 +87,41 @@ Coordinates get_computer_one_input(Board* board, PlayerTurn player) {
     return coords;
 }
 
+/**
+ * Works out where a computer player of the given type would want to place.
+ * The opening book is checked first, if there is one. Computer one's moves
+ * are then looked up in (and saved to) the shared transposition table;
+ * computer zero is cheaper than hashing the board. A looked up move that
+ * isn't a valid placement on this board is ignored
+ * @param board the main game board struct
+ * @param player the player whose turn it is
+ * @param type the type of computer player (COMPUTER_ZERO or COMPUTER_ONE)
+ */
+Coordinates get_computer_input(Board* board, PlayerTurn player,
+        PlayerType type) {
+
+    if (type == COMPUTER_ZERO && !book_in_use()) {
+        return get_computer_zero_input(board, player);
+    }
+
+    Coordinates coords;
+    uint64_t key = hash_board(board, player);
+
+    // the files are shared, so a stored move is only trusted if it's legal
+    if (probe_book(book_key(key, type), &coords)
+            && check_valid_placement(coords, board)) {
+        return coords;
+    }
+
+    if (type == COMPUTER_ZERO) {
+        return get_computer_zero_input(board, player);
+    }
 
+    if (!probe_table(key, &coords)
+            || !check_valid_placement(coords, board)) {
+        coords = get_computer_one_input(board, player);
+        store_table(key, coords);
+    }
 
+    return coords;
+}
@@ -1,4 +1,6 @@
 #include "types.h"
 
 Coordinates get_computer_zero_input(Board* board, PlayerTurn player);
-Coordinates get_computer_one_input(Board* board, PlayerTurn player);
\ No newline at end of file
+Coordinates get_computer_one_input(Board* board, PlayerTurn player);
+Coordinates get_computer_input(Board* board, PlayerTurn player,
+        PlayerType type);
\ No newline at end of file
@@ -0,0 +1,621 @@
+/**
+ * push2310-diff checks the rules engines against the original rules.
+ * It generates random positions, plays random moves on them with the
+ * original rules (original.c, a copy of logic.c from before it was
+ * optimised), the generic engine and the fixed size engine, and after
+ * every move compares each engine's valid placements, every cell of the
+ * board, the empty cell counts, game over and both scores against the
+ * original rules. The first difference is reported along with a savefile
+ * holding the position just before it. The starting positions are also
+ * scored in batches (batch.c) and compared against the original rules.
+ * Afterwards a sample of the games is replayed on each engine alone to
+ * measure how much faster the fast engine is.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include "types.h"
+#include "utility.h"
+#include "original.h"
+#include "batch.h"
+#include "engine.h"
+#include "fixed.h"
+#include "generate.h"
+
+#define DEFAULT_POSITIONS 100000
+#define DEFAULT_MOVES 64 // most moves played from each position
+#define DEFAULT_SEED 2310
+#define DEFAULT_REPRODUCER "push2310-diff.repro"
+#define MAX_SIZES 16
+#define TIMED_POSITIONS 20000 // positions replayed to measure speed
+#define TIMING_ROUNDS 5 // how many times the timed positions are replayed
+
+/**
+ * Settings for a run of the harness
+ */
+typedef struct DiffOptions {
+
+    long numPositions; // how many random positions to check
+    int maxMoves; // most moves to play from each position
+    uint64_t seed; // seed for the random positions and moves
+    char* reproducer; // where to write the position that differed
+    int sizes[MAX_SIZES]; // the board sizes to check (square boards)
+    int numSizes;
+} DiffOptions;
+
+/**
+ * The games kept to replay when timing the engines
+ */
+typedef struct TimedGames {
+
+    int count; // how many games have been kept
+    Board* boards; // each game's starting position
+    PlayerTurn* firstPlayers; // who moved first in each game
+    Coordinates* moves; // game k's moves start at moves[k * maxMoves]
+    int* numMoves; // how many moves each game has
+    int maxMoves;
+} TimedGames;
+
+/**
+ * Exit thrown when the harness is given bad arguments
+ */
+void exit_diff_usage(void) {
+
+    fprintf(stderr, "%s", "Usage: push2310-diff [-n positions] [-m moves] "
+            "[-s seed] [-o reproducer] [size...]\n");
+    exit(1);
+}
+
+/**
+ * Gets the time from a monotonic clock
+ * @returns the time in seconds
+ */
+double now(void) {
+
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**
+ * Creates the fast engine for a board, giving up if there isn't one
+ * @param board the board
+ * @returns the fast engine for it
+ */
+Engine make_fast_engine(Board* board) {
+
+    Engine engine;
+    if (!fixed_engine(board, &engine)) {
+        fprintf(stderr, "No fast engine for %dx%d boards\n", board->height,
+                board->width);
+        exit(1);
+    }
+    return engine;
+}
+
+/**
+ * Compares an engine's board with the original rules' board cell by cell,
+ * and its empty counts with those the original rules count by scanning
+ * @param original the board played on by the original rules
+ * @param board the board the engine plays on (or has synced into)
+ * @param engine the engine, for its name
+ * @param problem filled in with what differs
+ * @returns true if they are the same
+ */
+bool same_boards(Board* original, Board* board, Engine* engine,
+        char* problem) {
+
+    for (int i = 0; i < original->height; i++) {
+        for (int j = 0; j < original->width; j++) {
+            char expected = original->values[i][j][1];
+            char actual = board->values[i][j][1];
+            if (expected != actual) {
+                sprintf(problem, "cell %d %d is '%c' in the original rules, "
+                        "'%c' in the %s engine", i, j, expected, actual,
+                        engine->name);
+                return false;
+            }
+        }
+    }
+
+    for (int i = 0; i < original->height; i++) {
+        int expected = original_sum_empty_cells_in_row(i, original);
+        if (expected != board->emptyInRow[i]) {
+            sprintf(problem, "row %d has %d empty cells in the original "
+                    "rules, %d in the %s engine", i, expected,
+                    board->emptyInRow[i], engine->name);
+            return false;
+        }
+    }
+    for (int j = 0; j < original->width; j++) {
+        int expected = original_sum_empty_cells_in_col(j, original);
+        if (expected != board->emptyInCol[j]) {
+            sprintf(problem, "column %d has %d empty cells in the original "
+                    "rules, %d in the %s engine", j, expected,
+                    board->emptyInCol[j], engine->name);
+            return false;
+        }
+    }
+
+    int expected = 0;
+    for (int i = 1; i < original->height - 1; i++) {
+        for (int j = 1; j < original->width - 1; j++) {
+            if (original->values[i][j][1] == '.') {
+                expected++;
+            }
+        }
+    }
+    if (expected != board->emptyInterior) {
+        sprintf(problem, "the interior has %d empty cells in the original "
+                "rules, %d in the %s engine", expected, board->emptyInterior,
+                engine->name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Compares an engine's answers to game over and both scores with the
+ * original rules'
+ * @param original the board played on by the original rules
+ * @param engine the engine
+ * @param problem filled in with what differs
+ * @returns true if they agree
+ */
+bool same_results(Board* original, Engine* engine, char* problem) {
+
+    bool expected = original_check_game_over(original);
+    bool actual = engine->game_over(engine->state);
+    if (expected != actual) {
+        sprintf(problem, "game over is %d in the original rules, %d in the "
+                "%s engine", expected, actual, engine->name);
+        return false;
+    }
+
+    for (int player = PLAYER_O_TURN; player <= PLAYER_X_TURN; player++) {
+        int expectedScore = original_calculate_score(original, player);
+        int actualScore = engine->score(engine->state, player);
+        if (expectedScore != actualScore) {
+            sprintf(problem, "%c scores %d in the original rules, %d in the "
+                    "%s engine", (player == PLAYER_O_TURN) ? 'O' : 'X',
+                    expectedScore, actualScore, engine->name);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Asks the original rules and both engines whether a marker can go in
+ * every cell of the board (corners included), keeping the valid ones
+ * @param original the board played on by the original rules
+ * @param generic the generic engine
+ * @param fast the fast engine
+ * @param valid filled with the valid placements
+ * @param numValid set to how many there are
+ * @param problem filled in with what differs
+ * @returns true if the engines agree with the original rules on every cell
+ */
+bool same_placements(Board* original, Engine* generic, Engine* fast,
+        Coordinates* valid, int* numValid, char* problem) {
+
+    Engine* engines[] = {generic, fast};
+
+    *numValid = 0;
+    for (int i = 0; i < original->height; i++) {
+        for (int j = 0; j < original->width; j++) {
+            Coordinates coords = {i, j};
+            bool expected = original_check_valid_placement(coords, original);
+            for (int e = 0; e < 2; e++) {
+                bool actual = engines[e]->valid_placement(engines[e]->state,
+                        coords);
+                if (expected != actual) {
+                    sprintf(problem, "placing at %d %d is %s in the "
+                            "original rules, %s in the %s engine", i, j,
+                            expected ? "valid" : "invalid",
+                            actual ? "valid" : "invalid", engines[e]->name);
+                    return false;
+                }
+            }
+            if (expected) {
+                valid[(*numValid)++] = coords;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Picks a random move from the valid ones. Half the time the move is
+ * taken from the edges if any are valid, since pushes are where the
+ * engines are most likely to differ.
+ * @param valid the valid placements
+ * @param numValid how many there are
+ * @param board the board being played on
+ * @param state the random state
+ * @returns the move
+ */
+Coordinates pick_move(Coordinates* valid, int numValid, Board* board,
+        uint64_t* state) {
+
+    if (random_below(state, 2) == 0) {
+        int numEdges = 0;
+        for (int i = 0; i < numValid; i++) {
+            if (valid[i].row == 0 || valid[i].row == board->height - 1
+                    || valid[i].column == 0
+                    || valid[i].column == board->width - 1) {
+                numEdges++;
+            }
+        }
+        if (numEdges > 0) {
+            int pick = random_below(state, numEdges);
+            for (int i = 0; i < numValid; i++) {
+                if (valid[i].row == 0 || valid[i].row == board->height - 1
+                        || valid[i].column == 0
+                        || valid[i].column == board->width - 1) {
+                    if (pick-- == 0) {
+                        return valid[i];
+                    }
+                }
+            }
+        }
+    }
+    return valid[random_below(state, numValid)];
+}
+
+/**
+ * Writes the position where an engine differed, replaying the moves
+ * before the difference on the original rules, then exits
+ * @param options the harness settings
+ * @param start the position the game started from
+ * @param playerTurn who moved first
+ * @param moves the moves played
+ * @param numMoves how many of them came before the difference
+ * @param differingMove the move that caused the difference, or NULL
+ * @param position which generated position it was
+ * @param problem what differed
+ */
+void report_difference(DiffOptions* options, Board* start,
+        PlayerTurn playerTurn, Coordinates* moves, int numMoves,
+        Coordinates* differingMove, long position, char* problem) {
+
+    Board board = copy_board(start);
+    for (int i = 0; i < numMoves; i++) {
+        original_play(&board, playerTurn, moves[i]);
+        playerTurn = !playerTurn;
+    }
+
+    printf("position %ld (%dx%d), after %d moves: %s\n", position,
+            board.height, board.width, numMoves, problem);
+    if (differingMove != NULL) {
+        printf("differing move: %c at %d %d\n",
+                (playerTurn == PLAYER_O_TURN) ? 'O' : 'X',
+                differingMove->row, differingMove->column);
+    }
+
+    FILE* file = fopen(options->reproducer, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Can't write %s\n", options->reproducer);
+    } else {
+        write_savefile(file, &board, playerTurn);
+        fclose(file);
+        printf("position written to %s\n", options->reproducer);
+    }
+    exit(2);
+}
+
+/**
+ * Plays one random game from a position with the original rules and both
+ * engines, comparing the engines with the original rules after every move
+ * @param options the harness settings
+ * @param start the position, which is left unchanged
+ * @param playerTurn who moves first
+ * @param position which generated position this is, for reporting
+ * @param state the random state for picking moves
+ * @param moves filled with the moves played
+ * @returns the number of moves played
+ */
+int check_game(DiffOptions* options, Board* start, PlayerTurn playerTurn,
+        long position, uint64_t* state, Coordinates* moves) {
+
+    char problem[256];
+    PlayerTurn firstPlayer = playerTurn;
+    Board originalBoard = copy_board(start);
+    Board genericBoard = copy_board(start);
+    Board fastBoard = copy_board(start);
+    Engine generic = generic_engine(&genericBoard);
+    Engine fast = make_fast_engine(&fastBoard);
+    Coordinates* valid = malloc(sizeof(Coordinates) * start->height
+            * start->width);
+    check_allocated_memory(valid);
+
+    int numMoves = 0;
+    for (; ; numMoves++) {
+        int numValid;
+        if (!same_results(&originalBoard, &generic, problem)
+                || !same_results(&originalBoard, &fast, problem)
+                || !same_placements(&originalBoard, &generic, &fast,
+                        valid, &numValid, problem)) {
+            report_difference(options, start, firstPlayer, moves,
+                    numMoves, NULL, position, problem);
+        }
+        if (numMoves == options->maxMoves || numValid == 0
+                || original_check_game_over(&originalBoard)) {
+            break;
+        }
+
+        moves[numMoves] = pick_move(valid, numValid, &originalBoard,
+                state);
+        original_play(&originalBoard, playerTurn, moves[numMoves]);
+        generic.play(generic.state, playerTurn, moves[numMoves]);
+        fast.play(fast.state, playerTurn, moves[numMoves]);
+        fast.sync(fast.state, &fastBoard);
+        if (!same_boards(&originalBoard, &genericBoard, &generic, problem)
+                || !same_boards(&originalBoard, &fastBoard, &fast,
+                        problem)) {
+            report_difference(options, start, firstPlayer, moves,
+                    numMoves, &moves[numMoves], position, problem);
+        }
+        playerTurn = !playerTurn;
+    }
+
+    free(valid);
+    free_engine(&fast);
+    free_engine(&generic);
+    free_board(&fastBoard);
+    free_board(&genericBoard);
+    free_board(&originalBoard);
+    return numMoves;
+}
+
+/**
+ * Scores the kept games' starting positions in batches, one batch per
+ * board size, and compares the batch results with the original rules'
+ * scores and game over on each board
+ * @param options the harness settings
+ * @param games the kept games
+ * @returns the number of positions checked
+ */
+int check_batches(DiffOptions* options, TimedGames* games) {
+
+    char problem[256];
+    int* members = malloc(sizeof(int) * games->count);
+    check_allocated_memory(members);
+    int numChecked = 0;
+
+    for (int s = 0; s < options->numSizes; s++) {
+        int count = 0;
+        for (int k = 0; k < games->count; k++) {
+            if (games->boards[k].height == options->sizes[s]) {
+                members[count++] = k;
+            }
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        BoardBatch batch;
+        batch_init(&batch, options->sizes[s], options->sizes[s], count);
+        for (int i = 0; i < count; i++) {
+            batch_set_board(&batch, i, &games->boards[members[i]]);
+        }
+        batch_evaluate(&batch);
+
+        for (int i = 0; i < count; i++) {
+            Board* board = &games->boards[members[i]];
+            int naughts = original_calculate_score(board, PLAYER_O_TURN);
+            int crosses = original_calculate_score(board, PLAYER_X_TURN);
+            bool over = original_check_game_over(board);
+            if (naughts != batch.naughtScores[i]
+                    || crosses != batch.crossScores[i]
+                    || over != batch.gameOver[i]) {
+                sprintf(problem, "scores O %d X %d and game over %d, but "
+                        "the batch gives O %d X %d and game over %d",
+                        naughts, crosses, over, batch.naughtScores[i],
+                        batch.crossScores[i], batch.gameOver[i]);
+                report_difference(options, board, games->firstPlayers[
+                        members[i]], games->moves, 0, NULL, members[i],
+                        problem);
+            }
+        }
+        numChecked += count;
+        batch_free(&batch);
+    }
+
+    free(members);
+    return numChecked;
+}
+
+/**
+ * Replays every kept game on one engine, timing only the rules work (a
+ * placement check, the move and a game over check for each move)
+ * @param games the kept games
+ * @param fast true to time the fast engine, false for the generic one
+ * @param totalMoves set to the number of moves replayed
+ * @returns the time taken in seconds
+ */
+double time_engine(TimedGames* games, bool fast, long* totalMoves) {
+
+    Board* boards = malloc(sizeof(Board) * games->count);
+    Engine* engines = malloc(sizeof(Engine) * games->count);
+    check_allocated_memory(boards);
+    check_allocated_memory(engines);
+    double elapsed = 0;
+    int checks = 0; // keeps the checks from being optimised away
+    *totalMoves = 0;
+
+    for (int round = 0; round < TIMING_ROUNDS; round++) {
+        for (int k = 0; k < games->count; k++) {
+            boards[k] = copy_board(&games->boards[k]);
+            engines[k] = fast ? make_fast_engine(&boards[k])
+                    : generic_engine(&boards[k]);
+        }
+
+        double begin = now();
+        for (int k = 0; k < games->count; k++) {
+            Engine* engine = &engines[k];
+            Coordinates* moves = &games->moves[k * games->maxMoves];
+            PlayerTurn playerTurn = games->firstPlayers[k];
+            for (int i = 0; i < games->numMoves[k]; i++) {
+                checks += engine->valid_placement(engine->state, moves[i]);
+                engine->play(engine->state, playerTurn, moves[i]);
+                checks += engine->game_over(engine->state);
+                playerTurn = !playerTurn;
+            }
+            *totalMoves += games->numMoves[k];
+        }
+        elapsed += now() - begin;
+
+        for (int k = 0; k < games->count; k++) {
+            free_engine(&engines[k]);
+            free_board(&boards[k]);
+        }
+    }
+
+    if (checks < 0) {
+        printf("%d\n", checks);
+    }
+    free(engines);
+    free(boards);
+    return elapsed;
+}
+
+/**
+ * Reads the command line
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @param options filled in with the settings
+ */
+void parse_diff_options(int argc, char** argv, DiffOptions* options) {
+
+    int option;
+    char* end;
+
+    options->numPositions = DEFAULT_POSITIONS;
+    options->maxMoves = DEFAULT_MOVES;
+    options->seed = DEFAULT_SEED;
+    options->reproducer = DEFAULT_REPRODUCER;
+    while ((option = getopt(argc, argv, "n:m:s:o:")) != -1) {
+        switch (option) {
+            case 'n':
+                options->numPositions = strtol(optarg, &end, 10);
+                if (*end != '\0' || options->numPositions < 1) {
+                    exit_diff_usage();
+                }
+                break;
+            case 'm':
+                options->maxMoves = strtol(optarg, &end, 10);
+                if (*end != '\0' || options->maxMoves < 1) {
+                    exit_diff_usage();
+                }
+                break;
+            case 's':
+                options->seed = strtoull(optarg, &end, 10);
+                if (*end != '\0') {
+                    exit_diff_usage();
+                }
+                break;
+            case 'o':
+                options->reproducer = optarg;
+                break;
+            default:
+                exit_diff_usage();
+        }
+    }
+
+    options->numSizes = 0;
+    for (int i = optind; i < argc; i++) {
+        int size = strtol(argv[i], &end, 10);
+        if (*end != '\0' || size < 3 || options->numSizes == MAX_SIZES) {
+            exit_diff_usage();
+        }
+        options->sizes[options->numSizes++] = size;
+    }
+    if (options->numSizes == 0) {
+        int defaults[] = {5, 7, 9}; // the sizes fixed.c has kernels for
+        options->numSizes = 3;
+        memcpy(options->sizes, defaults, sizeof(defaults));
+    }
+}
+
+int main(int argc, char** argv) {
+
+    DiffOptions options;
+    TimedGames games;
+    uint64_t state;
+
+    parse_diff_options(argc, argv, &options);
+    state = options.seed;
+
+    games.count = 0;
+    games.maxMoves = options.maxMoves;
+    int numTimed = (options.numPositions < TIMED_POSITIONS)
+            ? options.numPositions : TIMED_POSITIONS;
+    games.boards = malloc(sizeof(Board) * numTimed);
+    games.firstPlayers = malloc(sizeof(PlayerTurn) * numTimed);
+    games.moves = malloc(sizeof(Coordinates) * numTimed * games.maxMoves);
+    games.numMoves = malloc(sizeof(int) * numTimed);
+    check_allocated_memory(games.boards);
+    check_allocated_memory(games.firstPlayers);
+    check_allocated_memory(games.moves);
+    check_allocated_memory(games.numMoves);
+    Coordinates* scratch = malloc(sizeof(Coordinates) * games.maxMoves);
+    check_allocated_memory(scratch); // moves of games that aren't kept
+
+    long totalMoves = 0;
+    for (long position = 0; position < options.numPositions; position++) {
+        GenOptions gen;
+        PlayerTurn playerTurn;
+        gen.height = options.sizes[position % options.numSizes];
+        gen.width = gen.height;
+        gen.distribution = random_below(&state, 4);
+        gen.density = random_fraction(&state);
+        gen.edgeDensity = random_fraction(&state) * 0.5;
+        gen.playerTurn = -1;
+        Board start = generate_board(&gen, &state, &playerTurn);
+
+        Coordinates* moves = (position < numTimed)
+                ? &games.moves[position * games.maxMoves] : scratch;
+        int numMoves = check_game(&options, &start, playerTurn, position,
+                &state, moves);
+        totalMoves += numMoves;
+
+        if (position < numTimed) {
+            games.boards[games.count] = start;
+            games.firstPlayers[games.count] = playerTurn;
+            games.numMoves[games.count++] = numMoves;
+        } else {
+            free_board(&start);
+        }
+    }
+    printf("%ld positions and %ld moves checked, no differences\n",
+            options.numPositions, totalMoves);
+    printf("%d positions scored in batches, no differences\n",
+            check_batches(&options, &games));
+
+    long genericMoves;
+    long fastMoves;
+    double genericTime = time_engine(&games, false, &genericMoves);
+    double fastTime = time_engine(&games, true, &fastMoves);
+    printf("generic: %.1f ns/move, fast: %.1f ns/move, %.2fx faster\n",
+            genericTime * 1e9 / (genericMoves ? genericMoves : 1),
+            fastTime * 1e9 / (fastMoves ? fastMoves : 1),
+            (fastTime > 0) ? genericTime / fastTime : 0);
+
+    for (int k = 0; k < games.count; k++) {
+        free_board(&games.boards[k]);
+    }
+    free(games.boards);
+    free(games.firstPlayers);
+    free(games.moves);
+    free(games.numMoves);
+    free(scratch);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * This file handles picking the rules engine for a game. The generic engine
+ * is the code in logic.c working directly on the Board; boards of some
+ * common sizes have specialised engines in fixed.c instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "types.h"
+#include "utility.h"
+#include "logic.h"
+#include "engine.h"
+#include "fixed.h"
+
+#define ENGINE_VARIABLE "PUSH2310_ENGINE" // set to "generic" to force it
+
+/**
+ * Generic engine: checks a placement with check_valid_placement
+ */
+bool generic_valid_placement(void* state, Coordinates coords) {
+
+    return check_valid_placement(coords, (Board*) state);
+}
+
+/**
+ * Generic engine: places a marker and pushes, with place_marker and
+ * push_markers
+ */
+void generic_play(void* state, PlayerTurn player, Coordinates coords) {
+
+    place_marker(player, coords, (Board*) state);
+    push_markers((Board*) state, coords);
+}
+
+/**
+ * Generic engine: checks for game over with check_game_over
+ */
+bool generic_game_over(void* state) {
+
+    return check_game_over((Board*) state);
+}
+
+/**
+ * Generic engine: works out a score with calculate_score
+ */
+int generic_score(void* state, PlayerTurn player) {
+
+    return calculate_score((Board*) state, player);
+}
+
+/**
+ * Generic engine: the board is the engine's state, so there is nothing to
+ * copy in either direction, and nothing to free
+ */
+void generic_nothing(void* state, Board* board) {
+}
+
+/**
+ * Generic engine: nothing to free; the board belongs to the caller
+ */
+void generic_free(void* state) {
+}
+
+/**
+ * Creates the generic engine, which works on board directly
+ * @param board the main game board struct
+ * @returns the generic engine for board
+ */
+Engine generic_engine(Board* board) {
+
+    Engine engine;
+    engine.name = "generic";
+    engine.state = board;
+    engine.valid_placement = generic_valid_placement;
+    engine.play = generic_play;
+    engine.game_over = generic_game_over;
+    engine.score = generic_score;
+    engine.sync = generic_nothing;
+    engine.reload = generic_nothing;
+    engine.free_state = generic_free;
+    return engine;
+}
+
+/**
+ * Picks the fastest engine available for a board; the specialised engine
+ * for its size if there is one, otherwise the generic engine.
+ * Setting PUSH2310_ENGINE=generic always picks the generic engine.
+ * @param board the main game board struct
+ * @returns the engine to play the game with
+ */
+Engine select_engine(Board* board) {
+
+    Engine engine;
+    char* choice = getenv(ENGINE_VARIABLE);
+
+    if (choice != NULL && strcmp(choice, "generic") == 0) {
+        return generic_engine(board);
+    }
+
+    if (fixed_engine(board, &engine)) {
+        return engine;
+    }
+
+    return generic_engine(board);
+}
+
+/**
+ * Frees whatever the engine allocated for its state
+ * @param engine the engine to free
+ */
+void free_engine(Engine* engine) {
+
+    engine->free_state(engine->state);
+    engine->state = NULL;
+}
@@ -0,0 +1,30 @@
+#ifndef ENGINE
+#define ENGINE
+
+#include <stdbool.h>
+#include "types.h"
+
+/**
+ * A rules engine; something that can apply moves and answer rules
+ * questions for one game. The Board struct is always what gets displayed
+ * and saved, an engine may keep its own faster copy of the position which
+ * sync writes back into the Board.
+ */
+typedef struct Engine {
+
+    const char* name; // name of the engine, for reporting
+    void* state; // the engine's own representation of the position
+    bool (*valid_placement)(void* state, Coordinates coords);
+    void (*play)(void* state, PlayerTurn player, Coordinates coords);
+    bool (*game_over)(void* state);
+    int (*score)(void* state, PlayerTurn player);
+    void (*sync)(void* state, Board* board); // engine -> board
+    void (*reload)(void* state, Board* board); // board -> engine
+    void (*free_state)(void* state);
+} Engine;
+
+Engine select_engine(Board* board);
+Engine generic_engine(Board* board);
+void free_engine(Engine* engine);
+
+#endif
@@ -0,0 +1,483 @@
+/**
+ * This file has rules engines specialised for boards of common fixed sizes.
+ * The position is kept as bitmasks (one per row and one per column, for
+ * each of empty, O and X) so that a push is a few shifts instead of a walk
+ * along the line. Every kernel is written once taking the board's height
+ * and width, and DEFINE_FIXED_KERNEL makes a copy of it with the size as a
+ * constant. Every loop over a row or column is marked FIXED_UNROLL, so in
+ * each copy the loops are completely unrolled.
+ *
+ * The kernels must give exactly the same results as logic.c, including its
+ * odd cases (e.g. markers placed in corners), as the two are mixed freely.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "types.h"
+#include "utility.h"
+#include "engine.h"
+#include "fixed.h"
+
+#define FIXED_MAX 16 // the largest height or width a mask can hold
+
+#define FIXED_INLINE static inline __attribute__((always_inline))
+
+// fully unrolls the loop it comes before, once the kernel's size is known
+#define FIXED_UNROLL _Pragma("GCC unroll 16")
+
+/**
+ * A position as bitmasks. Bit c of a row mask is cell (r, c), bit r of a
+ * column mask is cell (r, c). A cell in none of the masks holds some other
+ * symbol (only corners are allowed to).
+ */
+typedef struct FixedBoard {
+
+    uint16_t emptyRows[FIXED_MAX];
+    uint16_t naughtRows[FIXED_MAX];
+    uint16_t crossRows[FIXED_MAX];
+    uint16_t emptyCols[FIXED_MAX];
+    uint16_t naughtCols[FIXED_MAX];
+    uint16_t crossCols[FIXED_MAX];
+    int values[FIXED_MAX][FIXED_MAX]; // the value of each cell
+} FixedBoard;
+
+/**
+ * One specialised engine, for boards of exactly height by width
+ */
+typedef struct FixedKernel {
+
+    int height;
+    int width;
+    bool (*valid_placement)(void* state, Coordinates coords);
+    void (*play)(void* state, PlayerTurn player, Coordinates coords);
+    bool (*game_over)(void* state);
+    int (*score)(void* state, PlayerTurn player);
+    void (*sync)(void* state, Board* board);
+} FixedKernel;
+
+/**
+ * Gets one bit of a mask
+ * @param mask the mask
+ * @param bit the bit to get
+ * @returns true if the bit is set
+ */
+FIXED_INLINE bool test_bit(uint16_t mask, int bit) {
+
+    return (mask >> bit) & 1;
+}
+
+/**
+ * Sets or clears one bit of a mask
+ * @param mask the mask to change
+ * @param bit the bit to change
+ * @param value what to set the bit to
+ */
+FIXED_INLINE void put_bit(uint16_t* mask, int bit, bool value) {
+
+    *mask = (*mask & ~(1u << bit)) | ((unsigned) value << bit);
+}
+
+/**
+ * Sets cell (row, column) to a symbol, in both the row and column masks
+ * @param fixed the position
+ * @param row the row of the cell
+ * @param column the column of the cell
+ * @param symbol '.', 'O' or 'X'
+ */
+FIXED_INLINE void fixed_set(FixedBoard* fixed, int row, int column,
+        char symbol) {
+
+    put_bit(&fixed->emptyRows[row], column, symbol == '.');
+    put_bit(&fixed->naughtRows[row], column, symbol == 'O');
+    put_bit(&fixed->crossRows[row], column, symbol == 'X');
+    put_bit(&fixed->emptyCols[column], row, symbol == '.');
+    put_bit(&fixed->naughtCols[column], row, symbol == 'O');
+    put_bit(&fixed->crossCols[column], row, symbol == 'X');
+}
+
+/**
+ * Pushes one line (a row or a column) away from its first or last cell,
+ * the same way as push_vertical/push_horizontal: every cell up to the first
+ * empty one (or the far edge) moves along by one, and the edge is emptied.
+ * @param empty the line's empty mask
+ * @param naught the line's O mask
+ * @param cross the line's X mask
+ * @param length the number of cells in the line
+ * @param forward true to push from cell 0, false to push from the last
+ */
+FIXED_INLINE void push_line(uint16_t* empty, uint16_t* naught,
+        uint16_t* cross, int length, bool forward) {
+
+    unsigned all = (1u << length) - 1;
+    unsigned moving; // the cells that move along
+    unsigned end; // the cell they move into
+    unsigned gaps;
+
+    if (forward) {
+        gaps = *empty & all & ~1u;
+        end = gaps ? gaps & -gaps : 1u << (length - 1);
+        moving = end - 1;
+        *empty = (*empty & ~(moving | end)) | ((*empty & moving) << 1) | 1u;
+        *naught = (*naught & ~(moving | end)) | ((*naught & moving) << 1);
+        *cross = (*cross & ~(moving | end)) | ((*cross & moving) << 1);
+    } else {
+        gaps = *empty & (all >> 1);
+        end = gaps ? 1u << (31 - __builtin_clz(gaps)) : 1u;
+        moving = all & ~((end << 1) - 1);
+        *empty = (*empty & ~(moving | end)) | ((*empty & moving) >> 1)
+                | (1u << (length - 1));
+        *naught = (*naught & ~(moving | end)) | ((*naught & moving) >> 1);
+        *cross = (*cross & ~(moving | end)) | ((*cross & moving) >> 1);
+    }
+}
+
+/**
+ * Copies a column's masks back into the row masks after it was pushed
+ * @param fixed the position
+ * @param column the column that changed
+ * @param height the board height
+ */
+FIXED_INLINE void column_to_rows(FixedBoard* fixed, int column, int height) {
+
+    FIXED_UNROLL
+    for (int i = 0; i < height; i++) {
+        put_bit(&fixed->emptyRows[i], column,
+                test_bit(fixed->emptyCols[column], i));
+        put_bit(&fixed->naughtRows[i], column,
+                test_bit(fixed->naughtCols[column], i));
+        put_bit(&fixed->crossRows[i], column,
+                test_bit(fixed->crossCols[column], i));
+    }
+}
+
+/**
+ * Copies a row's masks back into the column masks after it was pushed
+ * @param fixed the position
+ * @param row the row that changed
+ * @param width the board width
+ */
+FIXED_INLINE void row_to_columns(FixedBoard* fixed, int row, int width) {
+
+    FIXED_UNROLL
+    for (int j = 0; j < width; j++) {
+        put_bit(&fixed->emptyCols[j], row,
+                test_bit(fixed->emptyRows[row], j));
+        put_bit(&fixed->naughtCols[j], row,
+                test_bit(fixed->naughtRows[row], j));
+        put_bit(&fixed->crossCols[j], row,
+                test_bit(fixed->crossRows[row], j));
+    }
+}
+
+/**
+ * Same as check_valid_placement, for a fixed size board
+ * @param fixed the position
+ * @param coords where the marker would go
+ * @param height the board height
+ * @param width the board width
+ * @returns true if the placement is valid
+ */
+FIXED_INLINE bool fixed_valid_placement(FixedBoard* fixed,
+        Coordinates coords, int height, int width) {
+
+    int row = coords.row;
+    int column = coords.column;
+    bool valid;
+
+    if (row < 0 || column < 0 || row >= height || column >= width) {
+        return false;
+    }
+
+    valid = test_bit(fixed->emptyRows[row], column);
+
+    if (row == 0 || row == height - 1) {
+        int adjacent = (row == 0) ? 1 : height - 2;
+        valid = !test_bit(fixed->emptyRows[adjacent], column)
+                && __builtin_popcount(fixed->emptyCols[column]) >= 2;
+    }
+
+    if (column == 0 || column == width - 1) {
+        int adjacent = (column == 0) ? 1 : width - 2;
+        valid = !test_bit(fixed->emptyRows[row], adjacent)
+                && __builtin_popcount(fixed->emptyRows[row]) >= 2;
+    }
+
+    return valid;
+}
+
+/**
+ * Same as place_marker followed by push_markers, for a fixed size board
+ * @param fixed the position
+ * @param player the player placing the marker
+ * @param coords where the marker goes
+ * @param height the board height
+ * @param width the board width
+ */
+FIXED_INLINE void fixed_play(FixedBoard* fixed, PlayerTurn player,
+        Coordinates coords, int height, int width) {
+
+    fixed_set(fixed, coords.row, coords.column,
+            player_enum_to_symbol(player));
+
+    // push_rows; the columns, from the top or bottom edge
+    FIXED_UNROLL
+    for (int j = 1; j < width - 1; j++) {
+        int numEmpty = __builtin_popcount(fixed->emptyCols[j]);
+        if (numEmpty == 0) {
+            continue;
+        }
+        if (!test_bit(fixed->emptyCols[j], 0)) {
+            if (numEmpty == 1 && (coords.row != 0 || coords.column != j)) {
+                continue;
+            }
+            push_line(&fixed->emptyCols[j], &fixed->naughtCols[j],
+                    &fixed->crossCols[j], height, true);
+            column_to_rows(fixed, j, height);
+            break;
+        } else if (!test_bit(fixed->emptyCols[j], height - 1)) {
+            if (numEmpty == 1
+                    && (coords.row != height - 1 || coords.column != j)) {
+                continue;
+            }
+            push_line(&fixed->emptyCols[j], &fixed->naughtCols[j],
+                    &fixed->crossCols[j], height, false);
+            column_to_rows(fixed, j, height);
+            break;
+        }
+    }
+
+    // push_cols; the rows, from the left or right edge
+    FIXED_UNROLL
+    for (int i = 1; i < height - 1; i++) {
+        int numEmpty = __builtin_popcount(fixed->emptyRows[i]);
+        if (numEmpty == 0) {
+            continue;
+        }
+        if (!test_bit(fixed->emptyRows[i], 0)) {
+            if (numEmpty == 1 && (coords.row != i || coords.column != 0)) {
+                continue;
+            }
+            push_line(&fixed->emptyRows[i], &fixed->naughtRows[i],
+                    &fixed->crossRows[i], width, true);
+            row_to_columns(fixed, i, width);
+            break;
+        } else if (!test_bit(fixed->emptyRows[i], width - 1)) {
+            if (numEmpty == 1
+                    && (coords.row != i || coords.column != width - 1)) {
+                continue;
+            }
+            push_line(&fixed->emptyRows[i], &fixed->naughtRows[i],
+                    &fixed->crossRows[i], width, false);
+            row_to_columns(fixed, i, width);
+            break;
+        }
+    }
+}
+
+/**
+ * Same as check_game_over, for a fixed size board
+ * @param fixed the position
+ * @param height the board height
+ * @param width the board width
+ * @returns true if there are no empty interior cells
+ */
+FIXED_INLINE bool fixed_game_over(FixedBoard* fixed, int height, int width) {
+
+    unsigned interior = ((1u << width) - 1) & ~1u & ~(1u << (width - 1));
+    unsigned empty = 0;
+
+    FIXED_UNROLL
+    for (int i = 1; i < height - 1; i++) {
+        empty |= fixed->emptyRows[i] & interior;
+    }
+
+    return empty == 0;
+}
+
+/**
+ * Same as calculate_score, for a fixed size board
+ * @param fixed the position
+ * @param player the player to score
+ * @param height the board height
+ * @param width the board width
+ * @returns the player's score
+ */
+FIXED_INLINE int fixed_score(FixedBoard* fixed, PlayerTurn player,
+        int height, int width) {
+
+    int totalScore = 0;
+
+    FIXED_UNROLL
+    for (int i = 1; i < height - 1; i++) {
+        uint16_t mine = (player == PLAYER_O_TURN)
+                ? fixed->naughtRows[i] : fixed->crossRows[i];
+        FIXED_UNROLL
+        for (int j = 1; j < width - 1; j++) {
+            totalScore += test_bit(mine, j) * fixed->values[i][j];
+        }
+    }
+
+    return totalScore;
+}
+
+/**
+ * Writes every cell whose symbol changed back into the board. Cells holding
+ * some other symbol (corners) are left alone.
+ * @param fixed the position
+ * @param board the main game board struct
+ * @param height the board height
+ * @param width the board width
+ */
+FIXED_INLINE void fixed_sync(FixedBoard* fixed, Board* board,
+        int height, int width) {
+
+    FIXED_UNROLL
+    for (int i = 0; i < height; i++) {
+        FIXED_UNROLL
+        for (int j = 0; j < width; j++) {
+            char symbol;
+            if (test_bit(fixed->emptyRows[i], j)) {
+                symbol = '.';
+            } else if (test_bit(fixed->naughtRows[i], j)) {
+                symbol = 'O';
+            } else if (test_bit(fixed->crossRows[i], j)) {
+                symbol = 'X';
+            } else {
+                continue;
+            }
+            if (board->values[i][j][1] != symbol) {
+                Coordinates coords = {i, j};
+                set_symbol(coords, board, symbol);
+            }
+        }
+    }
+}
+
+/**
+ * Makes the kernel functions for boards of height by width
+ */
+#define DEFINE_FIXED_KERNEL(H, W) \
+    static bool valid_placement_##H##x##W(void* state, Coordinates coords) { \
+        return fixed_valid_placement(state, coords, H, W); \
+    } \
+    static void play_##H##x##W(void* state, PlayerTurn player, \
+            Coordinates coords) { \
+        fixed_play(state, player, coords, H, W); \
+    } \
+    static bool game_over_##H##x##W(void* state) { \
+        return fixed_game_over(state, H, W); \
+    } \
+    static int score_##H##x##W(void* state, PlayerTurn player) { \
+        return fixed_score(state, player, H, W); \
+    } \
+    static void sync_##H##x##W(void* state, Board* board) { \
+        fixed_sync(state, board, H, W); \
+    }
+
+/**
+ * The FixedKernel entry for the functions made by DEFINE_FIXED_KERNEL
+ */
+#define FIXED_KERNEL(H, W) \
+    {H, W, valid_placement_##H##x##W, play_##H##x##W, game_over_##H##x##W, \
+            score_##H##x##W, sync_##H##x##W}
+
+DEFINE_FIXED_KERNEL(5, 5)
+DEFINE_FIXED_KERNEL(7, 7)
+DEFINE_FIXED_KERNEL(9, 9)
+
+static const FixedKernel kernels[] = {
+    FIXED_KERNEL(5, 5),
+    FIXED_KERNEL(7, 7),
+    FIXED_KERNEL(9, 9)
+};
+
+#define NUM_KERNELS ((int) (sizeof(kernels) / sizeof(kernels[0])))
+
+/**
+ * Checks to see if a cell is a corner of the board
+ * @param board the main game board struct
+ * @param row the row of the cell
+ * @param column the column of the cell
+ * @returns true if it's a corner
+ */
+bool is_corner(Board* board, int row, int column) {
+
+    return (row == 0 || row == board->height - 1)
+            && (column == 0 || column == board->width - 1);
+}
+
+/**
+ * Copies the board's position into the masks
+ * @param state the FixedBoard to load into
+ * @param board the main game board struct
+ */
+void fixed_reload(void* state, Board* board) {
+
+    FixedBoard* fixed = state;
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            fixed_set(fixed, i, j, board->values[i][j][1]);
+            fixed->values[i][j] = board->values[i][j][0] - '0';
+        }
+    }
+}
+
+/**
+ * Frees a FixedBoard
+ * @param state the FixedBoard
+ */
+void fixed_free(void* state) {
+
+    free(state);
+}
+
+/**
+ * Creates a specialised engine for the board, if there is a kernel for its
+ * size and it only holds '.', 'O' and 'X' away from the corners (anything
+ * else couldn't be pushed correctly by the masks).
+ * @param board the main game board struct
+ * @param engine where to put the engine
+ * @returns true if engine was filled in, false to use the generic engine
+ */
+bool fixed_engine(Board* board, Engine* engine) {
+
+    const FixedKernel* kernel = NULL;
+
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (kernels[k].height == board->height
+                && kernels[k].width == board->width) {
+            kernel = &kernels[k];
+        }
+    }
+
+    if (kernel == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            char symbol = board->values[i][j][1];
+            if (!is_corner(board, i, j) && symbol != '.' && symbol != 'O'
+                    && symbol != 'X') {
+                return false;
+            }
+        }
+    }
+
+    FixedBoard* fixed = calloc(1, sizeof(FixedBoard));
+    check_allocated_memory(fixed);
+    fixed_reload(fixed, board);
+
+    engine->name = "fixed";
+    engine->state = fixed;
+    engine->valid_placement = kernel->valid_placement;
+    engine->play = kernel->play;
+    engine->game_over = kernel->game_over;
+    engine->score = kernel->score;
+    engine->sync = kernel->sync;
+    engine->reload = fixed_reload;
+    engine->free_state = fixed_free;
+    return true;
+}
@@ -0,0 +1,10 @@
+#ifndef FIXED
+#define FIXED
+
+#include <stdbool.h>
+#include "types.h"
+#include "engine.h"
+
+bool fixed_engine(Board* board, Engine* engine);
+
+#endif
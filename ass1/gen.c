@@ -0,0 +1,199 @@
+/**
+ * push2310-gen writes random savefiles, for benchmarking and tournaments.
+ * The same arguments (including the seed) always give the same files.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "types.h"
+#include "utility.h"
+#include "generate.h"
+
+#define MIN_DIMENSION 3
+#define MAX_NAME_LEN 4096 // the longest output file name
+
+/**
+ * Settings for a run of the generator
+ */
+typedef struct GenArgs {
+
+    GenOptions options; // what each board should look like
+    uint64_t seed; // the seed for the first board
+    int count; // how many boards to write
+    char* prefix; // output file prefix, NULL to write to stdout
+} GenArgs;
+
+/**
+ * Exit thrown when the generator is given bad arguments
+ */
+void exit_gen_usage(void) {
+
+    fprintf(stderr, "%s", "Usage: push2310-gen [-v values] [-d density] "
+            "[-e edgeDensity] [-t O|X|R] [-s seed] [-n count] [-o prefix] "
+            "height width\n");
+    exit(1);
+}
+
+/**
+ * Converts a string to a fraction between 0 and 1, exiting if it isn't one
+ * @param value the string to convert
+ * @returns the fraction
+ */
+double parse_fraction(char* value) {
+
+    char* end;
+    double fraction = strtod(value, &end);
+
+    if (*end != '\0' || fraction < 0 || fraction > 1) {
+        exit_gen_usage();
+    }
+
+    return fraction;
+}
+
+/**
+ * Converts a string to an int which is at least min, exiting if it isn't
+ * @param value the string to convert
+ * @param min the smallest allowed value
+ * @returns the int
+ */
+int parse_int(char* value, int min) {
+
+    char* end;
+    long number = strtol(value, &end, 10);
+
+    if (*end != '\0' || number < min || number > INT32_MAX) {
+        exit_gen_usage();
+    }
+
+    return (int) number;
+}
+
+/**
+ * Converts a string to a random seed, exiting if it isn't a whole unsigned
+ * number
+ * @param value the string to convert
+ * @returns the seed
+ */
+uint64_t parse_seed(char* value) {
+
+    char* end;
+
+    if (!isdigit((unsigned char) value[0])) {
+        exit_gen_usage(); // strtoull would skip spaces and negate '-'
+    }
+    errno = 0;
+    unsigned long long seed = strtoull(value, &end, 10);
+    if (*end != '\0' || errno == ERANGE) {
+        exit_gen_usage();
+    }
+
+    return seed;
+}
+
+/**
+ * Reads the generator's arguments
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @returns the settings for this run
+ */
+GenArgs parse_gen_args(int argc, char** argv) {
+
+    GenArgs args;
+    args.options.distribution = UNIFORM_VALUES;
+    args.options.density = 0;
+    args.options.edgeDensity = 0;
+    args.options.playerTurn = PLAYER_O_TURN;
+    args.seed = 1;
+    args.count = 1;
+    args.prefix = NULL;
+
+    int option;
+    while ((option = getopt(argc, argv, "v:d:e:t:s:n:o:")) != -1) {
+        switch (option) {
+            case 'v':
+                if (!parse_distribution(optarg, &args.options.distribution)) {
+                    exit_gen_usage();
+                }
+                break;
+            case 'd':
+                args.options.density = parse_fraction(optarg);
+                break;
+            case 'e':
+                args.options.edgeDensity = parse_fraction(optarg);
+                break;
+            case 't':
+                if (strcmp(optarg, "R") == 0) {
+                    args.options.playerTurn = -1;
+                } else if (strlen(optarg) == 1
+                        && player_symbol_to_enum(optarg[0]) != -1) {
+                    args.options.playerTurn = player_symbol_to_enum(optarg[0]);
+                } else {
+                    exit_gen_usage();
+                }
+                break;
+            case 's':
+                args.seed = parse_seed(optarg);
+                break;
+            case 'n':
+                args.count = parse_int(optarg, 1);
+                break;
+            case 'o':
+                args.prefix = optarg;
+                break;
+            default:
+                exit_gen_usage();
+        }
+    }
+
+    if (argc - optind != 2 || (args.count > 1 && args.prefix == NULL)) {
+        exit_gen_usage();
+    }
+
+    args.options.height = parse_int(argv[optind], MIN_DIMENSION);
+    args.options.width = parse_int(argv[optind + 1], MIN_DIMENSION);
+
+    return args;
+}
+
+int main(int argc, char** argv) {
+
+    GenArgs args = parse_gen_args(argc, argv);
+    uint64_t state = args.seed;
+
+    for (int i = 0; i < args.count; i++) {
+        PlayerTurn playerTurn;
+        Board board = generate_board(&args.options, &state, &playerTurn);
+
+        FILE* file = stdout;
+        if (args.prefix != NULL) {
+            char fileName[MAX_NAME_LEN];
+            if (args.count == 1) {
+                snprintf(fileName, MAX_NAME_LEN, "%s", args.prefix);
+            } else {
+                snprintf(fileName, MAX_NAME_LEN, "%s%d", args.prefix, i);
+            }
+            if ((file = fopen(fileName, "w")) == NULL) {
+                fprintf(stderr, "Can't write %s\n", fileName);
+                exit(2);
+            }
+        }
+
+        write_savefile(file, &board, playerTurn);
+
+        if (file != stdout) {
+            fclose(file);
+        }
+        free_board(&board);
+    }
+
+    return 0;
+}
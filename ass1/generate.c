@@ -0,0 +1,171 @@
+/**
+ * This file handles generating random (but valid) boards, so the same
+ * inputs can be recreated from a seed for benchmarking and testing
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include "types.h"
+#include "utility.h"
+#include "generate.h"
+
+#define MIN_VALUE 1 // the lowest value an interior cell can have
+#define MAX_VALUE 9 // the highest value an interior cell can have
+
+/**
+ * Gets the next number from a seeded random number generator (splitmix64).
+ * Unlike rand(), this gives the same sequence on every platform.
+ * @param state the generator's state, initially the seed
+ * @returns the next 64 bit random number
+ */
+uint64_t next_random(uint64_t* state) {
+
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Gets a random number between 0 and bound - 1 inclusive
+ * @param state the generator's state
+ * @param bound one more than the largest number wanted
+ */
+int random_below(uint64_t* state, int bound) {
+
+    return (int) (next_random(state) % (uint64_t) bound);
+}
+
+/**
+ * Gets a random number between 0 (inclusive) and 1 (exclusive)
+ * @param state the generator's state
+ */
+double random_fraction(uint64_t* state) {
+
+    // the top 53 bits fill a double's mantissa exactly
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * Converts the name of a value distribution to its enum value
+ * @param name uniform, ones, low or high
+ * @param distribution set to the matching distribution
+ * @returns true iff name was a valid distribution
+ */
+bool parse_distribution(char* name, ValueDistribution* distribution) {
+
+    if (strcmp(name, "uniform") == 0) {
+        *distribution = UNIFORM_VALUES;
+    } else if (strcmp(name, "ones") == 0) {
+        *distribution = ONE_VALUES;
+    } else if (strcmp(name, "low") == 0) {
+        *distribution = LOW_VALUES;
+    } else if (strcmp(name, "high") == 0) {
+        *distribution = HIGH_VALUES;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Picks the value for an interior cell
+ * @param distribution how the value should be picked
+ * @param state the generator's state
+ * @returns a value between 1 and 9 inclusive
+ */
+int random_value(ValueDistribution distribution, uint64_t* state) {
+
+    int range = MAX_VALUE - MIN_VALUE + 1;
+    int low;
+    int other;
+
+    switch (distribution) {
+
+        case ONE_VALUES:
+            return MIN_VALUE;
+
+        case LOW_VALUES:
+            // the smaller of two rolls leans towards the minimum
+            low = random_below(state, range);
+            other = random_below(state, range);
+            return MIN_VALUE + (other < low ? other : low);
+
+        case HIGH_VALUES:
+            return MAX_VALUE - (random_value(LOW_VALUES, state) - MIN_VALUE);
+
+        default:
+            return MIN_VALUE + random_below(state, range);
+    }
+}
+
+/**
+ * Picks a random marker for a cell that is filled
+ * @param state the generator's state
+ * @returns 'O' or 'X'
+ */
+char random_marker(uint64_t* state) {
+
+    return random_below(state, 2) ? 'X' : 'O';
+}
+
+/**
+ * Generates a random board which get_values would accept; the corners are
+ * blank, edges have a value of 0 and there is always at least one empty
+ * interior cell. The same options and seed always give the same board.
+ * @param options the dimensions, values and fill of the board to make
+ * @param state the generator's state
+ * @param playerTurn set to the player who moves first on this board
+ * @returns the generated board (with its empty cell counts)
+ */
+Board generate_board(GenOptions* options, uint64_t* state,
+        PlayerTurn* playerTurn) {
+
+    Board board;
+    board.height = options->height;
+    board.width = options->width;
+    board.values = allocate_board_memory(board.height, board.width);
+
+    for (int i = 0; i < board.height; i++) {
+        for (int j = 0; j < board.width; j++) {
+            char* cell = board.values[i][j];
+            bool rowEdge = (i == 0 || i == board.height - 1);
+            bool colEdge = (j == 0 || j == board.width - 1);
+
+            cell[2] = '\0';
+            if (rowEdge && colEdge) {
+                cell[0] = ' ';
+                cell[1] = ' ';
+            } else if (rowEdge || colEdge) {
+                cell[0] = '0';
+                cell[1] = (random_fraction(state) < options->edgeDensity)
+                        ? random_marker(state) : '.';
+            } else {
+                cell[0] = '0' + random_value(options->distribution, state);
+                cell[1] = (random_fraction(state) < options->density)
+                        ? random_marker(state) : '.';
+            }
+        }
+    }
+
+    // a board with a full interior can't be loaded, so free up a cell
+    if (check_full_load(board.values, board.height, board.width)) {
+        int row = 1 + random_below(state, board.height - 2);
+        int col = 1 + random_below(state, board.width - 2);
+        board.values[row][col][1] = '.';
+    }
+
+    if (options->playerTurn == -1) {
+        *playerTurn = random_below(state, 2);
+    } else {
+        *playerTurn = options->playerTurn;
+    }
+
+    count_empty_cells(&board);
+
+    return board;
+}
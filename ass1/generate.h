@@ -0,0 +1,26 @@
+#include <stdint.h>
+#include "types.h"
+
+typedef enum ValueDistribution {
+    UNIFORM_VALUES, // every interior value 1 to 9 equally likely
+    ONE_VALUES, // every interior value is 1
+    LOW_VALUES, // interior values skewed towards 1
+    HIGH_VALUES // interior values skewed towards 9
+} ValueDistribution;
+
+typedef struct GenOptions {
+
+    int height; // the height of the boards to generate
+    int width; // the width of the boards to generate
+    ValueDistribution distribution; // how interior values are picked
+    double density; // the fraction of interior cells with a marker
+    double edgeDensity; // the fraction of edge cells with a marker
+    int playerTurn; // PLAYER_O_TURN, PLAYER_X_TURN or -1 for random
+} GenOptions;
+
+uint64_t next_random(uint64_t* state);
+int random_below(uint64_t* state, int bound);
+double random_fraction(uint64_t* state);
+bool parse_distribution(char* name, ValueDistribution* distribution);
+Board generate_board(GenOptions* options, uint64_t* state,
+        PlayerTurn* playerTurn);
@@ -3,19 +3,29 @@
 #include "utility.h"
 
 /**
- * Prints the board values to the terminal
+ * Writes the board values to a file, in the same layout as a savefile
+ * @param file the file to write to
  * @param board a pointer to the board struct declared in main.c
  */
-void print_board(Board* board) {
+void write_board(FILE* file, Board* board) {
 
     for (int i = 0; i < board->height; i++) {
         for (int j = 0; j < board->width; j++) {
-            printf("%s", board->values[i][j]);
+            fputs(board->values[i][j], file);
         }
-        printf("\n");
+        putc('\n', file);
     }
 }
 
+/**
+ * Prints the board values to the terminal
+ * @param board a pointer to the board struct declared in main.c
+ */
+void print_board(Board* board) {
+
+    write_board(stdout, board);
+}
+
 /**
  * Prints the human move prompt, using that player's symbol (i.e. O or X) to
  * the terminal
@@ -1,5 +1,8 @@
+#include <stdio.h>
 #include "types.h"
 
+void write_board(FILE* file, Board* board);
+
 void print_board(Board* board);
 void print_human_move_prompt(PlayerTurn playerTurn);
 void print_computer_placed_move(PlayerTurn playerTurn, Coordinates coords);
\ No newline at end of file
@@ -0,0 +1,249 @@
+/**
+ * This file handles the history of moves in a game; see history.h.
+ * Changes are collected by pointing the board's journal at the history
+ * while a move is played, since every symbol change goes through
+ * set_symbol. Once the moves since the last snapshot have changed as many
+ * cells as the board has, a copy of all the symbols is also kept. So the
+ * copies cost no more than the changes they follow, and jumping to any
+ * move replays at most about a board's worth of changes.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "types.h"
+#include "utility.h"
+#include "history.h"
+
+/**
+ * Copies every symbol on the board
+ * @param board the main game board struct
+ * @returns the symbols, row by row
+ */
+char* take_snapshot(Board* board) {
+
+    char* snapshot = malloc((size_t) board->height * board->width);
+    check_allocated_memory(snapshot);
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            snapshot[(size_t) i * board->width + j] = board->values[i][j][1];
+        }
+    }
+
+    return snapshot;
+}
+
+/**
+ * Creates a history node
+ * @param parent the node before, NULL for the root
+ * @returns the node, with no changes
+ */
+HistoryNode* new_history_node(HistoryNode* parent) {
+
+    HistoryNode* node = calloc(1, sizeof(HistoryNode));
+    check_allocated_memory(node);
+
+    node->parent = parent;
+    node->depth = (parent == NULL) ? 0 : parent->depth + 1;
+    return node;
+}
+
+/**
+ * Starts a history for a game
+ * @param board the main game board struct, in its starting position
+ * @returns the history, with no moves
+ */
+History* new_history(Board* board) {
+
+    History* history = malloc(sizeof(History));
+    check_allocated_memory(history);
+
+    history->root = new_history_node(NULL);
+    history->root->snapshot = take_snapshot(board);
+    history->current = history->root;
+    history->journal.changes = NULL;
+    history->journal.length = 0;
+    history->journal.capacity = 0;
+    return history;
+}
+
+/**
+ * Starts recording a move; call before placing the marker
+ * @param history the game's history
+ * @param board the main game board struct
+ */
+void begin_history_move(History* history, Board* board) {
+
+    history->journal.length = 0;
+    board->journal = &history->journal;
+}
+
+/**
+ * Stops recording a move and adds it after the current position, as a new
+ * branch if other moves were already played from there
+ * @param history the game's history
+ * @param board the main game board struct
+ * @param move where the marker was placed
+ * @param player who placed it
+ */
+void end_history_move(History* history, Board* board, Coordinates move,
+        PlayerTurn player) {
+
+    HistoryNode* parent = history->current;
+    HistoryNode* node = new_history_node(parent);
+    int numChanges = history->journal.length;
+
+    board->journal = NULL;
+
+    node->move = move;
+    node->player = player;
+    node->numChanges = numChanges;
+    node->changes = malloc(sizeof(CellChange) * (numChanges + 1));
+    check_allocated_memory(node->changes);
+    memcpy(node->changes, history->journal.changes,
+            sizeof(CellChange) * numChanges);
+    // counted along the branch, so every path back to a snapshot is short
+    node->sinceSnapshot = numChanges
+            + ((parent->snapshot != NULL) ? 0 : parent->sinceSnapshot);
+    if (node->sinceSnapshot >= (long) board->height * board->width) {
+        node->snapshot = take_snapshot(board);
+    }
+
+    node->nextSibling = parent->firstChild;
+    parent->firstChild = node;
+    parent->redoChild = node;
+    history->current = node;
+}
+
+/**
+ * Reverts the current move
+ * @param history the game's history
+ * @param board the main game board struct
+ * @returns false if there was no move to undo
+ */
+bool undo_move(History* history, Board* board) {
+
+    HistoryNode* node = history->current;
+
+    if (node->parent == NULL) {
+        return false;
+    }
+
+    for (int i = node->numChanges - 1; i >= 0; i--) {
+        CellChange* change = &node->changes[i];
+        Coordinates coords = {change->row, change->column};
+        set_symbol(coords, board, change->before);
+    }
+
+    node->parent->redoChild = node;
+    history->current = node->parent;
+    return true;
+}
+
+/**
+ * Applies a move's changes to the board
+ * @param node the move
+ * @param board the main game board struct, in the move's parent position
+ */
+void apply_history_node(HistoryNode* node, Board* board) {
+
+    for (int i = 0; i < node->numChanges; i++) {
+        CellChange* change = &node->changes[i];
+        Coordinates coords = {change->row, change->column};
+        set_symbol(coords, board, change->after);
+    }
+}
+
+/**
+ * Plays the most recently undone (or played) move from here again
+ * @param history the game's history
+ * @param board the main game board struct
+ * @returns false if there was no move to redo
+ */
+bool redo_move(History* history, Board* board) {
+
+    HistoryNode* node = history->current->redoChild;
+
+    if (node == NULL) {
+        return false;
+    }
+
+    apply_history_node(node, board);
+    history->current = node;
+    return true;
+}
+
+/**
+ * Moves the board to any position in the history, on any branch. Starts
+ * from the nearest snapshot before the target and replays the moves after
+ * it, so costs one board plus at most about a board's worth of changes.
+ * @param history the game's history
+ * @param board the main game board struct
+ * @param target the position to go to
+ */
+void jump_to_move(History* history, Board* board, HistoryNode* target) {
+
+    HistoryNode* start = target;
+    while (start->snapshot == NULL) {
+        start = start->parent;
+    }
+
+    // the moves from the snapshot to the target, last first
+    int pathLength = target->depth - start->depth;
+    HistoryNode** path = malloc(sizeof(HistoryNode*) * (pathLength + 1));
+    check_allocated_memory(path);
+    HistoryNode* node = target;
+    for (int i = 0; i < pathLength; i++) {
+        path[i] = node;
+        node = node->parent;
+    }
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            char symbol = start->snapshot[(size_t) i * board->width + j];
+            if (board->values[i][j][1] != symbol) {
+                Coordinates coords = {i, j};
+                set_symbol(coords, board, symbol);
+            }
+        }
+    }
+
+    while (pathLength > 0) {
+        node = path[--pathLength];
+        apply_history_node(node, board);
+        node->parent->redoChild = node;
+    }
+
+    free(path);
+    history->current = target;
+}
+
+/**
+ * Frees a history and all of its moves. Games can be millions of moves
+ * long, so rather than recursing, each node's children are moved into the
+ * sibling list being freed.
+ * @param history the history to free
+ */
+void free_history(History* history) {
+
+    HistoryNode* node = history->root;
+
+    while (node != NULL) {
+        if (node->firstChild != NULL) {
+            HistoryNode* child = node->firstChild;
+            node->firstChild = child->nextSibling;
+            child->nextSibling = node->nextSibling;
+            node->nextSibling = child;
+            continue;
+        }
+        HistoryNode* next = node->nextSibling;
+        free(node->changes);
+        free(node->snapshot);
+        free(node);
+        node = next;
+    }
+
+    free(history->journal.changes);
+    free(history);
+}
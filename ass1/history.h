@@ -0,0 +1,47 @@
+#ifndef HISTORY
+#define HISTORY
+
+#include <stdbool.h>
+#include "types.h"
+
+/**
+ * One move in the history tree. A move only stores the cells it changed
+ * (the placed marker and everything the push moved), so undo and redo
+ * cost the size of the move, not the size of the board.
+ */
+typedef struct HistoryNode {
+
+    struct HistoryNode* parent; // the move before, NULL for the start
+    struct HistoryNode* firstChild; // moves played from here, newest first
+    struct HistoryNode* nextSibling; // other moves played from the parent
+    struct HistoryNode* redoChild; // the child redo goes to
+    Coordinates move; // where the marker was placed
+    PlayerTurn player; // who placed it
+    int depth; // the number of moves since the start
+    CellChange* changes; // the cells the move changed, in order
+    int numChanges;
+    long sinceSnapshot; // changes since the nearest snapshot, up to here
+    char* snapshot; // every symbol after this move, on some nodes only
+} HistoryNode;
+
+/**
+ * Every move played in a game, as a tree: playing a move after an undo
+ * starts a new branch, and the old moves are kept.
+ */
+typedef struct History {
+
+    HistoryNode* root; // the position the game was loaded in
+    HistoryNode* current; // the position on the board now
+    Journal journal; // collects the changes of the move being played
+} History;
+
+History* new_history(Board* board);
+void begin_history_move(History* history, Board* board);
+void end_history_move(History* history, Board* board, Coordinates move,
+        PlayerTurn player);
+bool undo_move(History* history, Board* board);
+bool redo_move(History* history, Board* board);
+void jump_to_move(History* history, Board* board, HistoryNode* target);
+void free_history(History* history);
+
+#endif
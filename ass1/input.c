@@ -7,6 +7,7 @@
 #include "types.h"
 #include "logic.h"
 #include "exit.h"
+#include "input.h"
 
 #define MAX_LINE 80 // this is the max input length according to spec
 
@@ -14,7 +15,8 @@ void save_game(char* saveFileName, Board* board, PlayerTurn playerTurn);
 
 /**
  * Prompts the player for input until a valid row and column is entered and
- * returns coordinates
+ * returns coordinates. If the player asks to undo or redo instead, the row
+ * is UNDO_INPUT or REDO_INPUT
  * @param playerTurn which player's turn it is
  * @param board pointer to main game board struct
  * @returns Coordinates struct containing row and column specified
@@ -32,6 +34,13 @@ Coordinates get_player_input(PlayerTurn playerTurn, Board* board) {
             exit_end_of_file();
         }
 
+        // player wants to undo or redo their last turn
+        if (strcmp(buffer, "u\n") == 0 || strcmp(buffer, "r\n") == 0) {
+            coordinates.row = (buffer[0] == 'u') ? UNDO_INPUT : REDO_INPUT;
+            coordinates.column = 0;
+            break;
+        }
+
         // new line character is counted, so if only one character is entered
         if (strlen(buffer) == 2) {
             continue; // one character input is always invalid
@@ -69,23 +78,6 @@ void save_game(char* saveFileName, Board* board, PlayerTurn playerTurn) {
         return;
     }
 
-    char* buffer = malloc(sizeof(char) * MAX_LINE);
-
-    // adding rows and cols to top of file
-    sprintf(buffer, "%d %d\n", board->height, board->width);
-    fputs(buffer, file);
-
-    // adding player turn to file
-    sprintf(buffer, "%c\n", player_enum_to_symbol(playerTurn));
-    fputs(buffer, file);
-
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            fputs(board->values[i][j], file);
-        }
-        fputs("\n", file);
-    }
-
+    write_savefile(file, board, playerTurn);
     fclose(file);
-    free(buffer);
 }
\ No newline at end of file
@@ -1,3 +1,6 @@
 #include "types.h"
 
+#define UNDO_INPUT -2 // row from get_player_input when the player enters u
+#define REDO_INPUT -3 // row from get_player_input when the player enters r
+
 Coordinates get_player_input(PlayerTurn playerTurn, Board* board);
\ No newline at end of file
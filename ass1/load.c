@@ -9,6 +9,7 @@
 #include "exit.h"
 #include "types.h"
 #include "utility.h"
+#include "load.h"
 
 #define MIN_DIMENSION 3
 #define MAX_SAVEFILE_LINE 80 // not sure this is correct,
@@ -155,6 +156,48 @@ PlayerTurn get_player_turn(char* fileName) {
     return playerTurn;
 }
 
+/**
+ * Skips the rest of the current line in a file
+ * @param file the file to skip the line in
+ */
+void skip_line(FILE* file) {
+
+    int c;
+    while ((c = getc(file)) != '\n' && c != EOF) {
+        // nothing to do, just consuming characters
+    }
+}
+
+/**
+ * Reads the rows of board values from a savefile, a character at a time,
+ * so there is no limit on how wide the board can be
+ * @param file the savefile, positioned at the start of the first row
+ * @param values where to put the values, already allocated
+ * @param height the board height
+ * @param width the board width
+ * @returns false if a row was too short
+ */
+bool read_board_rows(FILE* file, char*** values, int height, int width) {
+
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) { 
+            int value = getc(file);
+            int symbol = (value == '\n' || value == EOF) ? EOF : getc(file);
+
+            if (symbol == '\n' || symbol == EOF) {
+                return false; // line is too short
+            }
+
+            values[i][j][0] = value;
+            values[i][j][1] = symbol;
+            values[i][j][2] = '\0';
+        }
+        skip_line(file); // removes trailing new line character
+    }
+
+    return true;
+}
+
 /**
  * Gets the values of the board from the savefile
  * @param fileName the name of the savefile
@@ -167,33 +210,16 @@ char*** get_values(char* fileName, int height, int width) {
         exit_load_file_error();
     }
 
-    char buffer[MAX_SAVEFILE_LINE];
-
     // allocating memory for multidimensional array
     char*** values = allocate_board_memory(height, width);
 
     // skip first 2 lines of savefile
     for (int i = 0; i < 2; i++) {
-        fgets(buffer, MAX_SAVEFILE_LINE, file); 
+        skip_line(file);
     }
 
-    // read through each line of board values in savefile
-    for (int i = 0; i < height; i++) {
-
-        fgets(buffer, MAX_SAVEFILE_LINE, file);
-        strtok(buffer, "\n"); // removes trailing new line character
-    
-        for (int j = 0; j < width * 2; j += 2) { 
-
-            if ((i == 0 || i == height) && j >= width * 2 - 2) {
-                //continue;
-                // i don't think is needed, leaving in just in case
-            }
-
-            values[i][j / 2][0] = buffer[j];
-            values[i][j / 2][1] = buffer[j + 1];   
-            values[i][j / 2][2] = '\0';                     
-        }
+    if (!read_board_rows(file, values, height, width)) {
+        exit_invalid_file();
     }
 
     if (check_full_load(values, height, width)) {
@@ -203,3 +229,87 @@ char*** get_values(char* fileName, int height, int width) {
     fclose(file);
     return values;
 }
+
+/**
+ * Reads a whole savefile into a board, like get_board_dimensions,
+ * get_player_turn and get_values together, but returns what was wrong with
+ * the file instead of exiting. For programs that load many savefiles.
+ * @param file the savefile, opened for reading
+ * @param board where to put the board, its values are allocated if LOAD_OK
+ * @param playerTurn where to put whose turn it is
+ * @param maxCells the most cells a board may have, or 0 for no limit
+ * @returns LOAD_OK, or the reason the savefile is invalid
+ */
+LoadStatus read_savefile(FILE* file, Board* board, PlayerTurn* playerTurn,
+        long maxCells) {
+
+    char buffer[MAX_SAVEFILE_LINE];
+
+    if (fgets(buffer, MAX_SAVEFILE_LINE, file) == NULL) {
+        return LOAD_BAD_DIMENSIONS;
+    }
+    char* height = strtok(buffer, " ");
+    char* width = strtok(NULL, " ");
+    if (height == NULL || width == NULL) {
+        return LOAD_BAD_DIMENSIONS;
+    }
+    board->height = atoi(height);
+    board->width = atoi(width);
+    if (board->height < MIN_DIMENSION || board->width < MIN_DIMENSION) {
+        return LOAD_BAD_DIMENSIONS;
+    }
+    if (maxCells > 0 && (long) board->height * board->width > maxCells) {
+        return LOAD_TOO_LARGE;
+    }
+
+    // checking for > 2 and not > 1 since all fgets ends with '\n'
+    if (fgets(buffer, MAX_SAVEFILE_LINE, file) == NULL
+            || strlen(buffer) > 2
+            || (*playerTurn = player_symbol_to_enum(buffer[0])) == -1) {
+        return LOAD_BAD_TURN;
+    }
+
+    board->values = allocate_board_memory(board->height, board->width);
+    board->emptyInRow = NULL;
+    board->emptyInCol = NULL;
+
+    if (!read_board_rows(file, board->values, board->height, board->width)) {
+        free_board(board);
+        return LOAD_SHORT_ROW;
+    }
+
+    if (check_full_load(board->values, board->height, board->width)) {
+        free_board(board);
+        return LOAD_FULL_BOARD;
+    }
+
+    count_empty_cells(board);
+    return LOAD_OK;
+}
+
+/**
+ * Describes why read_savefile failed
+ * @param status what read_savefile returned
+ * @returns a short description
+ */
+const char* load_status_message(LoadStatus status) {
+
+    switch (status) {
+        case LOAD_OK:
+            return "ok";
+        case LOAD_BAD_DIMENSIONS:
+            return "invalid dimensions";
+        case LOAD_TOO_LARGE:
+            return "board too large";
+        case LOAD_BAD_TURN:
+            return "invalid player turn";
+        case LOAD_SHORT_ROW:
+            return "board row too short";
+        case LOAD_BAD_CELL:
+            return "invalid cell";
+        case LOAD_FULL_BOARD:
+            return "no empty interior cells";
+    }
+
+    return "unknown error";
+}
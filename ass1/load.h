@@ -1,5 +1,16 @@
+#ifndef LOAD
+#define LOAD
+
+#include <stdio.h>
 #include "types.h"
 
+/**
+ * What read_savefile found wrong with a savefile, if anything
+ */
+typedef enum LoadStatus {LOAD_OK, LOAD_BAD_DIMENSIONS, LOAD_TOO_LARGE,
+        LOAD_BAD_TURN, LOAD_SHORT_ROW, LOAD_BAD_CELL, LOAD_FULL_BOARD}
+        LoadStatus;
+
 // ### ARGUMENT CHECKING FUNCTIONS ###
 
 void check_num_args(int argc);
@@ -12,5 +23,11 @@ PlayerType* get_player_types(char** argv);
 int* get_board_dimensions(char* fileName);
 PlayerTurn get_player_turn(char* fileName);
 char*** get_values(char* fileName, int height, int width);
+bool read_board_rows(FILE* file, char*** values, int height, int width);
+LoadStatus read_savefile(FILE* file, Board* board, PlayerTurn* playerTurn,
+        long maxCells);
+const char* load_status_message(LoadStatus status);
+
+Coordinates find_lower_score(Board* board, PlayerTurn player);
 
-Coordinates find_lower_score(Board* board, PlayerTurn player);
\ No newline at end of file
+#endif
\ No newline at end of file
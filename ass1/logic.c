@@ -6,6 +6,7 @@
 #include "types.h"
 #include "utility.h"
 #include "logic.h"
+#include "stats.h"
 
 /**
  * Checks whether the cell at the specified coordinates is empty or not
@@ -26,6 +27,7 @@ bool check_cell_empty(Coordinates coordinates, Board* board) {
 bool check_valid_placement(Coordinates coordinates, Board* board) {
 
     bool valid = true;
+    STAT_ADD(validPlacementCalls, 1);
 
     if (coordinates.row >= board->height
             || coordinates.column >= board->width) {
@@ -120,8 +122,9 @@ bool check_horizontal_push_valid(Coordinates coordinates, Board* board) {
 }
 
 /**
- * After a valid marker is placed, this function checks the entire board to 
- * see if anything needs to be pushed.
+ * After a valid marker is placed, this function checks the edges of the board
+ * to see if anything needs to be pushed. Only the edge cells and the line
+ * being pushed are looked at, so the cost doesn't grow with the board's area.
  * @param board the main game board struct
  * @param lastPlaced the coordinates of the marker that was just placed
  * (this is included so rows or columns with 1 empty space on the end doesn't
@@ -222,56 +225,75 @@ void push_cols(Board* board, Coordinates lastPlaced) {
 }
 
 /**
- * Recursive algorithm which Pushes the marker at coords up/down 
- * if there is an empty spot.
- * If there isn't an empty spot, push up/down is recursively called on that 
- * non-empty spot 
+ * Pushes the marker at coords up/down by one cell. Every marker between it and
+ * the first empty cell in that direction is pushed along one cell as well.
+ * If there is no empty cell, the markers are pushed up to the far edge and
+ * the marker which was on the far edge is pushed off the board.
+ * Only the cells which actually move are touched.
  * @param coords the coordinates of the marker to be pushed
  * @param board the main game board
  * @param down whether the markers are being pushed down or up
  */
 void push_vertical(Coordinates coords, Board* board, bool down) {
 
-    Coordinates adjacentCell = get_adjacent_vertical_cell(coords, board, down);
+    int step = down ? 1 : -1;
+    int lastRow = down ? board->height - 1 : 0; // the far edge
 
-    if (adjacentCell.row == -1) {
-        return;
+    if (coords.row == lastRow) {
+        return; // nowhere to push to
     }
 
-    if (!check_cell_empty(adjacentCell, board)) {
-        push_vertical(adjacentCell, board, down);
-    } 
-
-    char symbol = get_symbol(coords, board);
-    board->values[adjacentCell.row][adjacentCell.column][1] = symbol;
-    board->values[coords.row][coords.column][1] = '.';
+    // find where the push stops
+    Coordinates end = coords;
+    do {
+        end.row += step;
+    } while (end.row != lastRow && !check_cell_empty(end, board));
+
+    // move everything along one, starting from the far end
+    Coordinates from = end;
+    while (from.row != coords.row) {
+        Coordinates to = from;
+        from.row -= step;
+        set_symbol(to, board, get_symbol(from, board));
+    }
+    set_symbol(coords, board, '.');
+    STAT_PUSH(abs(end.row - coords.row));
 }
 
 /**
- * Recursive algorithm which Pushes the marker at coords right/left,
- * if there is an empty spot.
- * If there isn't an empty spot, push down is recursively called on that 
- * non-empty spot 
+ * Pushes the marker at coords right/left by one cell. Every marker between it
+ * and the first empty cell in that direction is pushed along one cell as well.
+ * If there is no empty cell, the markers are pushed up to the far edge and
+ * the marker which was on the far edge is pushed off the board.
+ * Only the cells which actually move are touched.
  * @param coords the coordinates of the marker to be pushed
  * @param board the main game board
- * @param down whether the markers are being pushed down or up
+ * @param right whether the markers are being pushed right or left
  */
 void push_horizontal(Coordinates coords, Board* board, bool right) {
 
-    Coordinates adjacentCell =
-            get_adjacent_horizontal_cell(coords, board, right);
+    int step = right ? 1 : -1;
+    int lastColumn = right ? board->width - 1 : 0; // the far edge
 
-    if (adjacentCell.column == -1) {
-        return;
+    if (coords.column == lastColumn) {
+        return; // nowhere to push to
     }
 
-    if (!check_cell_empty(adjacentCell, board)) {
-        push_horizontal(adjacentCell, board, right);
-    } 
-
-    char symbol = get_symbol(coords, board);
-    board->values[adjacentCell.row][adjacentCell.column][1] = symbol;
-    board->values[coords.row][coords.column][1] = '.';
+    // find where the push stops
+    Coordinates end = coords;
+    do {
+        end.column += step;
+    } while (end.column != lastColumn && !check_cell_empty(end, board));
+
+    // move everything along one, starting from the far end
+    Coordinates from = end;
+    while (from.column != coords.column) {
+        Coordinates to = from;
+        from.column -= step;
+        set_symbol(to, board, get_symbol(from, board));
+    }
+    set_symbol(coords, board, '.');
+    STAT_PUSH(abs(end.column - coords.column));
 }
 
 /**
@@ -282,6 +304,10 @@ void push_horizontal(Coordinates coords, Board* board, bool right) {
  */
 bool check_game_over(Board* board) {
 
+    if (board->emptyInRow != NULL) {
+        return board->emptyInterior == 0;
+    }
+
     for (int i = 1; i < board->height - 1; i++) {
         for (int j = 1; j < board->width - 1; j++) {
             if (board->values[i][j][1] == '.') {
@@ -398,7 +424,7 @@ Coordinates find_lower_score_top_row(Board* board, PlayerTurn otherPlayer) {
         Board boardCopy = copy_board(board);
         push_vertical(edge, &boardCopy, true);
         int postPushScore = calculate_score(&boardCopy, otherPlayer);
-        free_board_values(boardCopy.values, boardCopy.height, boardCopy.width);
+        free_board(&boardCopy);
 
         if (postPushScore < prePushScore) {
             return edge;
@@ -435,7 +461,7 @@ Coordinates find_lower_score_right_col(Board* board, PlayerTurn otherPlayer) {
         Board boardCopy = copy_board(board);
         push_horizontal(edge, &boardCopy, false);
         int postPushScore = calculate_score(&boardCopy, otherPlayer);
-        free_board_values(boardCopy.values, boardCopy.height, boardCopy.width);
+        free_board(&boardCopy);
 
         if (postPushScore < prePushScore) {
             return edge;
@@ -472,7 +498,7 @@ Coordinates find_lower_score_bottom_row(Board* board, PlayerTurn otherPlayer) {
         Board boardCopy = copy_board(board);
         push_vertical(edge, &boardCopy, false);
         int postPushScore = calculate_score(&boardCopy, otherPlayer);
-        free_board_values(boardCopy.values, boardCopy.height, boardCopy.width);
+        free_board(&boardCopy);
 
         if (postPushScore < prePushScore) {
             return edge;
@@ -509,7 +535,7 @@ Coordinates find_lower_score_left_col(Board* board, PlayerTurn otherPlayer) {
         Board boardCopy = copy_board(board);
         push_horizontal(edge, &boardCopy, true);
         int postPushScore = calculate_score(&boardCopy, otherPlayer);
-        free_board_values(boardCopy.values, boardCopy.height, boardCopy.width);
+        free_board(&boardCopy);
 
         if (postPushScore < prePushScore) {
             return edge;
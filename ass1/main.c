@@ -7,6 +7,11 @@
 #include "input.h"
 #include "logic.h"
 #include "computer.h"
+#include "table.h"
+#include "book.h"
+#include "stats.h"
+#include "engine.h"
+#include "history.h"
 
 /**
  * Checks the program arguments
@@ -53,34 +58,45 @@ void load_board_dimensions(Board* board, char* saveFileName) {
 Coordinates handle_move(Game* game, Board* board) {
 
     Coordinates coordinates;
-
-    if (game->playerTurn == PLAYER_O_TURN) {
-        if (game->playerOType == HUMAN) {
-            coordinates = get_player_input(game->playerTurn, board);
-        } else {
-            if (game->playerOType == COMPUTER_ZERO) {
-                coordinates = get_computer_zero_input(board, PLAYER_O_TURN);
-            } else if (game->playerOType == COMPUTER_ONE) {
-                coordinates = get_computer_one_input(board, PLAYER_O_TURN);
-            }
-            print_computer_placed_move(game->playerTurn, coordinates);
-        }
+    PlayerType type = (game->playerTurn == PLAYER_O_TURN)
+            ? game->playerOType : game->playerXType;
+    STAT_TIMER_START(timer);
+
+    if (type == HUMAN) {
+        coordinates = get_player_input(game->playerTurn, board);
+    } else {
+        coordinates = get_computer_input(board, game->playerTurn, type);
+        print_computer_placed_move(game->playerTurn, coordinates);
     }
 
-    if (game->playerTurn == PLAYER_X_TURN) {
-        if (game->playerXType == HUMAN) {
-            coordinates = get_player_input(game->playerTurn, board);
-        } else {
-            if (game->playerXType == COMPUTER_ZERO) {
-                coordinates = get_computer_zero_input(board, PLAYER_X_TURN);
-            } else if (game->playerXType == COMPUTER_ONE) {
-                coordinates = get_computer_one_input(board, PLAYER_X_TURN);
-            }
-            print_computer_placed_move(game->playerTurn, coordinates);
+    STAT_TIMER_STOP(timer, type);
+    return coordinates;
+}
+
+/**
+ * Undoes or redoes a human's last turn. That's two moves, so that it's the
+ * same player's turn again afterwards. Does nothing if there aren't two
+ * moves to go back (or forward) over.
+ * @param game pointer to main game object declared in main
+ * @param board pointer to main board object declared in main
+ * @param engine the engine playing the game, which is reloaded
+ * @param undo true to undo, false to redo
+ */
+void change_history(Game* game, Board* board, Engine* engine, bool undo) {
+
+    History* history = game->history;
+
+    if (undo) {
+        if (undo_move(history, board) && !undo_move(history, board)) {
+            redo_move(history, board);
+        }
+    } else {
+        if (redo_move(history, board) && !redo_move(history, board)) {
+            undo_move(history, board);
         }
     }
 
-    return coordinates;
+    engine->reload(engine->state, board);
 }
 
 int main(int argc, char** argv) {
@@ -95,6 +111,7 @@ int main(int argc, char** argv) {
 
     // checking arguments
     check_arguments(argc, argv);
+    init_stats(); // only does anything if compiled with PUSH2310_STATS
 
     // if this line is reached, args are valid.
     saveFileName = argv[3];
@@ -104,6 +121,15 @@ int main(int argc, char** argv) {
     load_board_dimensions(&board, saveFileName);
     game.playerTurn = get_player_turn(saveFileName);
     board.values = get_values(saveFileName, board.height, board.width);
+    count_empty_cells(&board);
+    open_table(); // only does anything if PUSH2310_TABLE is set
+    open_book(); // only does anything if PUSH2310_BOOK is set
+
+    // fixed size boards get a specialised engine, others the generic one
+    Engine engine = select_engine(&board);
+    // only a human can undo or redo, so other games keep no history
+    game.history = (game.playerOType == HUMAN || game.playerXType == HUMAN)
+            ? new_history(&board) : NULL;
 
     // main game loop
     Coordinates coordinates;
@@ -113,12 +139,25 @@ int main(int argc, char** argv) {
 
         // coordinates = get_player_input(game.playerTurn, &board);
         coordinates = handle_move(&game, &board);
-        place_marker(game.playerTurn, coordinates, &board);
-        push_markers(&board, coordinates); 
+        if (coordinates.row == UNDO_INPUT || coordinates.row == REDO_INPUT) {
+            change_history(&game, &board, &engine,
+                    coordinates.row == UNDO_INPUT);
+            continue;
+        }
+
+        if (game.history != NULL) {
+            begin_history_move(game.history, &board);
+        }
+        engine.play(engine.state, game.playerTurn, coordinates);
+        engine.sync(engine.state, &board); // board is what gets printed
+        if (game.history != NULL) {
+            end_history_move(game.history, &board, coordinates,
+                    game.playerTurn);
+        }
 
         game.playerTurn ^= 1;
 
-        game.gameOver = check_game_over(&board);
+        game.gameOver = engine.game_over(engine.state);
     }
 
     print_board(&board);
@@ -128,7 +167,13 @@ int main(int argc, char** argv) {
     printf("Winners: %s\n", winner);
 
     // board values were allocated dynamically, must free
-    free_board_values(board.values, board.height, board.width);
+    if (game.history != NULL) {
+        free_history(game.history);
+    }
+    free_engine(&engine);
+    free_board(&board);
+    close_table();
+    close_book();
     
     return 0;
 }
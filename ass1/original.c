@@ -0,0 +1,455 @@
+/**
+ * This file is the original rules of push2310, as logic.c and utility.c
+ * had them before any of the engines were optimised: recursive pushes,
+ * and empty cells counted by scanning the row or column every time. Only
+ * the names have changed (so they can be linked next to logic.c), and
+ * place_marker followed by push_markers is original_play. push2310-diff
+ * checks every engine against these, so don't optimise them.
+ */
+
+#include <stdbool.h>
+#include "types.h"
+#include "utility.h"
+#include "original.h"
+
+static bool original_check_vertical_push_valid(Coordinates coordinates,
+        Board* board);
+static bool original_check_horizontal_push_valid(Coordinates coordinates,
+        Board* board);
+static void original_push_vertical(Coordinates coords, Board* board,
+        bool down);
+static void original_push_horizontal(Coordinates coords, Board* board,
+        bool right);
+
+/**
+ * Checks if two coordinates are equal
+ * @param coords1 the first pair of coordinates
+ * @param coords2 the second pair of coordinates
+ * @returns true if both row and column are equal
+ */
+static bool original_coordinates_equal(Coordinates coords1,
+        Coordinates coords2) {
+
+    return ((coords1.row == coords2.row)
+            && (coords1.column == coords2.column));
+}
+
+/**
+ * Gets the non-numerical symbol at certain coords
+ * i.e. O or X or .
+ * @param coords the coordinates you want to get the marker for
+ * @param board the main game board
+ * @returns the char symbol at that location on the board
+ */
+static char original_get_symbol(Coordinates coords, Board* board) {
+
+    return (board->values[coords.row][coords.column][1]);
+}
+
+/**
+ * Checks whether the cell at the specified coordinates is empty or not
+ * @param coordinates the coordinates of the cell
+ * @param board the main board struct
+ * @returns true if the cell is empty (i.e. has a '.' in it), false otherwise
+ */
+static bool original_check_cell_empty(Coordinates coordinates,
+        Board* board) {
+    return ((board->values[coordinates.row][coordinates.column][1]) == '.');
+}
+
+/**
+ * Gets the vertically adjacent cell from the cell in coords.
+ * @param coords the cell you want to find the adjacent cell to
+ * @param board the main game board struct
+ * NOTE: in this context adjacent means the cell that the cell in coords
+ * would be pushed towards.
+ */
+static Coordinates original_get_adjacent_vertical_cell
+        (Coordinates coords, Board* board, bool down) {
+
+    Coordinates adjacentCell;
+    adjacentCell.column = coords.column;
+
+    if (down) {
+        adjacentCell.row = ++coords.row;
+    } else {
+        adjacentCell.row = --coords.row;
+    }
+
+    if (adjacentCell.row >= board->height || adjacentCell.row < 0) {
+        adjacentCell.row = -1;
+    }
+
+    return adjacentCell;
+}
+
+/**
+ * Gets the horizontally adjacent cell from the cell in coords.
+ * @param coords the cell you want to find the adjacent cell to
+ * @param board the main game board struct
+ * NOTE: in this context adjacent means the cell that the cell in coords
+ * would be pushed towards.
+ */
+static Coordinates original_get_adjacent_horizontal_cell
+        (Coordinates coords, Board* board, bool right) {
+
+    Coordinates adjacentCell;
+    adjacentCell.row = coords.row;
+
+    if (right) {
+        adjacentCell.column = ++coords.column;
+    } else {
+        adjacentCell.column = --coords.column;
+    }
+
+    if (adjacentCell.column >= board->width || adjacentCell.column < 0) {
+        adjacentCell.column = -1;
+    }
+
+    return adjacentCell;
+}
+
+/**
+ * Counts how many empty cells (i.e. cells that equal '.') in a row
+ * @param row the row to check
+ * @param board the main game board struct
+ * @returns the number of empty cells in the row
+ */
+int original_sum_empty_cells_in_row(int row, Board* board) {
+
+    int numEmpty = 0;
+
+    for (int i = 0; i < board->width; i++) {
+        if (board->values[row][i][1] == '.') {
+            numEmpty++;
+        }
+    }
+
+    return numEmpty;
+}
+
+/**
+ * Counts how many empty cells (i.e. cells that equal '.') in a column
+ * @param col the column to check
+ * @param board the main game board struct
+ * @returns the number of empty cells in the row
+ */
+int original_sum_empty_cells_in_col(int col, Board* board) {
+
+    int numEmpty = 0;
+
+    for (int i = 0; i < board->height; i++) {
+        if (board->values[i][col][1] == '.') {
+            numEmpty++;
+        }
+    }
+
+    return numEmpty;
+}
+
+/**
+ * Determines if the location the player/computer wants to place their marker
+ * is valid
+ * @param coordinates coordinates struct containing the row and col to check
+ * @param board the main game board struct
+ */
+bool original_check_valid_placement(Coordinates coordinates, Board* board) {
+
+    bool valid = true;
+
+    if (coordinates.row >= board->height
+            || coordinates.column >= board->width) {
+        // we return here so program doesn't try to read invalid memory
+        return false;
+    }
+
+    if (coordinates.row < 0 || coordinates.column < 0) {
+        return false;
+    }
+
+    if (board->values[coordinates.row][coordinates.column][1] != '.') {
+        valid = false;
+    }
+
+    // need to check push validity
+    // Stones can only be played in an edge cell if:
+    // 1. There is an empty cell in the direction it would be pushed.
+    // 2. There is a stone to be pushed immediately next to the edge cell
+
+    if (coordinates.row == 0 || coordinates.row == board->height - 1) {
+        valid = original_check_vertical_push_valid(coordinates, board);
+    }
+
+    if (coordinates.column == 0 || coordinates.column == board->width - 1) {
+        valid = original_check_horizontal_push_valid(coordinates, board);
+    }
+
+    return valid;
+}
+
+/**
+ * Checks to see if a marker placed on an vertical edge is valid.
+ * I.e., it checks to see if there is
+ * 1. a marker existing already to be pushed
+ * 2. at least one spot for the one or more markers in the row to be pushed to
+ * NOTE: Make sure you only call this function if you *know* the row = 0
+ * @param coordinates the coordinates of the location on the board to check
+ * @param board the main game board struct
+ */
+static bool original_check_vertical_push_valid(Coordinates coordinates,
+        Board* board) {
+
+    bool valid = false;
+
+    Coordinates adjacentCell; // coordinates for the adjacent cell
+    adjacentCell.column = coordinates.column; // has same column
+
+    if (coordinates.row == 0) {
+        adjacentCell.row = 1;
+    }
+
+    if (coordinates.row == board->height - 1) {
+        adjacentCell.row = board->height - 2;
+    }
+
+    // the adjacent cell must be filled, thus the !
+    valid = !original_check_cell_empty(adjacentCell, board);
+
+    valid = valid
+            && (original_sum_empty_cells_in_col(coordinates.column, board)
+            >= 2);
+
+    return valid;
+}
+
+/**
+ * Checks to see if a marker placed on a horizontal edge is valid.
+ * I.e., it checks to see if there is
+ * 1. a marker existing already to be pushed
+ * 2. at least one spot for the one or more markers in the col to be pushed to
+ * NOTE: Make sure you only call this function if you *know* the col = 0
+ * @param coordinates the coordinates of the location on the board to check
+ * @param board the main game board struct
+ */
+static bool original_check_horizontal_push_valid(Coordinates coordinates,
+        Board* board) {
+
+    bool valid = false;
+
+    Coordinates adjacentCell; // coordinates for the adjacent cell
+    adjacentCell.row = coordinates.row; // has the same row
+
+    if (coordinates.column == 0) {
+        adjacentCell.column = 1;
+    }
+
+    if (coordinates.column == board->width - 1) {
+        adjacentCell.column = board->width - 2;
+    }
+
+    valid = !original_check_cell_empty(adjacentCell, board);
+    valid = valid
+            && (original_sum_empty_cells_in_row(coordinates.row, board) >= 2);
+
+    return valid;
+}
+
+/**
+ * Checks all the rows and pushes if anything needs to be pushed
+ * @param board the main game board struct
+ * @param lastPlaced the coordinates of the marker that was just placed
+ */
+static void original_push_rows(Board* board, Coordinates lastPlaced) {
+
+    Coordinates coords;
+    for (int i = 1; i < board->width - 1; i++) {
+
+        int emptyCellsInCol = original_sum_empty_cells_in_col(i, board);
+
+        if (emptyCellsInCol == 0) {
+            continue;
+        }
+
+        if (board->values[0][i][1] != '.') {
+            coords.row = 0;
+            coords.column = i;
+
+            if (emptyCellsInCol == 1
+                    && !original_coordinates_equal(lastPlaced, coords)) {
+                continue;
+            }
+
+            original_push_vertical(coords, board, true);
+
+            return;
+        } else if (board->values[board->height - 1][i][1] != '.') {
+            coords.row = board->height - 1;
+            coords.column = i;
+
+            if (emptyCellsInCol == 1
+                    && !original_coordinates_equal(lastPlaced, coords)) {
+                continue;
+            }
+
+            original_push_vertical(coords, board, false);
+
+            return;
+        }
+    }
+}
+
+/**
+ * Checks all the cols and pushes if anything needs to be pushed
+ * @param board the main game board struct
+ * @param lastPlaced the coordinates of the marker that was just placed
+ */
+static void original_push_cols(Board* board, Coordinates lastPlaced) {
+
+    Coordinates coords;
+    for (int i = 1; i < board->height - 1; i++) {
+
+        int emptyCellsInRow = original_sum_empty_cells_in_row(i, board);
+
+        if (emptyCellsInRow == 0) {
+            continue;
+        }
+
+        if (board->values[i][0][1] != '.') {
+            coords.row = i;
+            coords.column = 0;
+
+            if (emptyCellsInRow == 1
+                    && !original_coordinates_equal(lastPlaced, coords)) {
+                continue;
+            }
+
+            original_push_horizontal(coords, board, true);
+
+            return;
+        } else if (board->values[i][board->width - 1][1] != '.') {
+            coords.row = i;
+            coords.column = board->width - 1;
+
+            if (emptyCellsInRow == 1
+                    && !original_coordinates_equal(lastPlaced, coords)) {
+                continue;
+            }
+
+            original_push_horizontal(coords, board, false);
+
+            return;
+        }
+    }
+}
+
+/**
+ * Recursive algorithm which Pushes the marker at coords up/down
+ * if there is an empty spot.
+ * If there isn't an empty spot, push up/down is recursively called on that
+ * non-empty spot
+ * @param coords the coordinates of the marker to be pushed
+ * @param board the main game board
+ * @param down whether the markers are being pushed down or up
+ */
+static void original_push_vertical(Coordinates coords, Board* board,
+        bool down) {
+
+    Coordinates adjacentCell =
+            original_get_adjacent_vertical_cell(coords, board, down);
+
+    if (adjacentCell.row == -1) {
+        return;
+    }
+
+    if (!original_check_cell_empty(adjacentCell, board)) {
+        original_push_vertical(adjacentCell, board, down);
+    }
+
+    char symbol = original_get_symbol(coords, board);
+    board->values[adjacentCell.row][adjacentCell.column][1] = symbol;
+    board->values[coords.row][coords.column][1] = '.';
+}
+
+/**
+ * Recursive algorithm which Pushes the marker at coords right/left,
+ * if there is an empty spot.
+ * If there isn't an empty spot, push down is recursively called on that
+ * non-empty spot
+ * @param coords the coordinates of the marker to be pushed
+ * @param board the main game board
+ * @param down whether the markers are being pushed down or up
+ */
+static void original_push_horizontal(Coordinates coords, Board* board,
+        bool right) {
+
+    Coordinates adjacentCell =
+            original_get_adjacent_horizontal_cell(coords, board, right);
+
+    if (adjacentCell.column == -1) {
+        return;
+    }
+
+    if (!original_check_cell_empty(adjacentCell, board)) {
+        original_push_horizontal(adjacentCell, board, right);
+    }
+
+    char symbol = original_get_symbol(coords, board);
+    board->values[adjacentCell.row][adjacentCell.column][1] = symbol;
+    board->values[coords.row][coords.column][1] = '.';
+}
+
+/**
+ * Places a marker and pushes whatever that makes move, as the original
+ * main loop did with place_marker and push_markers
+ * @param board the main game board struct
+ * @param playerTurn the player placing the marker
+ * @param coords where the marker goes, already known to be valid
+ */
+void original_play(Board* board, PlayerTurn playerTurn, Coordinates coords) {
+
+    char marker = player_enum_to_symbol(playerTurn);
+    board->values[coords.row][coords.column][1] = marker;
+
+    original_push_rows(board, coords);
+    original_push_cols(board, coords);
+}
+
+/**
+ * Looks through the values on the board and determines if the game is over or
+ * not
+ * @param board the main game board struct
+ * @return true if the game is over, false otherwise.
+ */
+bool original_check_game_over(Board* board) {
+
+    for (int i = 1; i < board->height - 1; i++) {
+        for (int j = 1; j < board->width - 1; j++) {
+            if (board->values[i][j][1] == '.') {
+                return false; // only need one space
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Returns the current score of a player
+ * @param board the main game board struct
+ * @param playerTurn the player whose turn it is
+ */
+int original_calculate_score(Board* board, PlayerTurn playerTurn) {
+
+    int totalScore = 0;
+    char symbol = player_enum_to_symbol(playerTurn);
+
+    for (int i = 1; i < board->height - 1; i++) {
+        for (int j = 1; j < board->width - 1; j++) {
+            if (board->values[i][j][1] == symbol) {
+                totalScore += (board->values[i][j][0] - '0');
+            }
+        }
+    }
+
+    return totalScore;
+}
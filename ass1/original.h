@@ -0,0 +1,14 @@
+#ifndef ORIGINAL
+#define ORIGINAL
+
+#include <stdbool.h>
+#include "types.h"
+
+bool original_check_valid_placement(Coordinates coordinates, Board* board);
+void original_play(Board* board, PlayerTurn playerTurn, Coordinates coords);
+bool original_check_game_over(Board* board);
+int original_calculate_score(Board* board, PlayerTurn playerTurn);
+int original_sum_empty_cells_in_row(int row, Board* board);
+int original_sum_empty_cells_in_col(int col, Board* board);
+
+#endif
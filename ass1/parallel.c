@@ -0,0 +1,244 @@
+/**
+ * This file handles evaluating computer one's edge moves on multiple threads
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "types.h"
+#include "utility.h"
+#include "logic.h"
+#include "parallel.h"
+
+#define THREADS_VARIABLE "PUSH2310_THREADS" // env var with number of threads
+#define MAX_THREADS 64 // more threads than this won't help with board copies
+
+/**
+ * An edge cell computer one could place at, and the way it would push
+ */
+typedef struct EdgeCandidate {
+
+    Coordinates edge; // the edge cell being placed on
+    bool vertical; // true if the push goes along a column
+    bool forward; // true if the push goes down/right, false if up/left
+} EdgeCandidate;
+
+/**
+ * State shared between all the threads evaluating one move
+ */
+typedef struct CandidateSearch {
+
+    Board* board; // the board being searched (never modified)
+    PlayerTurn otherPlayer; // the player whose score is to be lowered
+    int prePushScore; // otherPlayer's score before any push
+    EdgeCandidate* candidates; // every edge in the serial priority order
+    int numCandidates; // the number of candidates
+    int next; // index of the next candidate a thread should evaluate
+    int best; // lowest index found which lowers the score
+    pthread_mutex_t lock; // protects next and best
+} CandidateSearch;
+
+/**
+ * Works out how many threads computer one should use, from the
+ * PUSH2310_THREADS environment variable. "0" means one per online cpu.
+ * @returns the number of threads to use; 1 means use the serial search
+ */
+int get_computer_threads(void) {
+
+    static int numThreads = -1; // only read the environment once
+
+    if (numThreads != -1) {
+        return numThreads;
+    }
+
+    numThreads = 1;
+    char* value = getenv(THREADS_VARIABLE);
+    if (value != NULL && value[0] != '\0') {
+        numThreads = atoi(value);
+        if (numThreads == 0) {
+            numThreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+        }
+    }
+
+    if (numThreads < 1) {
+        numThreads = 1;
+    }
+    if (numThreads > MAX_THREADS) {
+        numThreads = MAX_THREADS;
+    }
+
+    return numThreads;
+}
+
+/**
+ * Adds the edge cells of the board to candidates, in the same order the
+ * serial find_lower_score checks them (top, right, bottom, left)
+ * @param board the main game board struct
+ * @param candidates array with room for every edge cell on the board
+ * @returns the number of candidates added
+ */
+int list_edge_candidates(Board* board, EdgeCandidate* candidates) {
+
+    int count = 0;
+
+    // top row, left to right, pushing down
+    for (int j = 1; j < board->width - 1; j++) {
+        candidates[count].edge.row = 0;
+        candidates[count].edge.column = j;
+        candidates[count].vertical = true;
+        candidates[count++].forward = true;
+    }
+
+    // right column, top to bottom, pushing left
+    for (int row = 1; row < board->height - 1; row++) {
+        candidates[count].edge.row = row;
+        candidates[count].edge.column = board->width - 1;
+        candidates[count].vertical = false;
+        candidates[count++].forward = false;
+    }
+
+    // bottom row, right to left, pushing up
+    for (int j = board->width - 2; j > 0; j--) {
+        candidates[count].edge.row = board->height - 1;
+        candidates[count].edge.column = j;
+        candidates[count].vertical = true;
+        candidates[count++].forward = false;
+    }
+
+    // left column, bottom to top, pushing right
+    for (int row = board->height - 2; row > 0; row--) {
+        candidates[count].edge.row = row;
+        candidates[count].edge.column = 0;
+        candidates[count].vertical = false;
+        candidates[count++].forward = true;
+    }
+
+    return count;
+}
+
+/**
+ * Checks whether pushing from a single edge would lower the other player's
+ * score. Only reads search->board; the push happens on a private copy.
+ * @param search the shared search state
+ * @param candidate the edge to check
+ * @returns true iff the push is valid and lowers the other player's score
+ */
+bool candidate_lowers_score(CandidateSearch* search,
+        EdgeCandidate* candidate) {
+
+    Board* board = search->board;
+
+    if (candidate->vertical
+            && !check_vertical_push_valid(candidate->edge, board)) {
+        return false;
+    }
+    if (!candidate->vertical
+            && !check_horizontal_push_valid(candidate->edge, board)) {
+        return false;
+    }
+
+    Board boardCopy = copy_board(board);
+    if (candidate->vertical) {
+        push_vertical(candidate->edge, &boardCopy, candidate->forward);
+    } else {
+        push_horizontal(candidate->edge, &boardCopy, candidate->forward);
+    }
+    int postPushScore = calculate_score(&boardCopy, search->otherPlayer);
+    free_board(&boardCopy);
+
+    return postPushScore < search->prePushScore;
+}
+
+/**
+ * Thread body: keeps taking the next unevaluated candidate until every
+ * candidate with an index lower than the best found so far is done
+ * @param arg pointer to the shared CandidateSearch
+ */
+void* evaluate_candidates(void* arg) {
+
+    CandidateSearch* search = (CandidateSearch*) arg;
+
+    while (true) {
+        pthread_mutex_lock(&search->lock);
+        int index = search->next++;
+        bool done = index >= search->numCandidates || index > search->best;
+        pthread_mutex_unlock(&search->lock);
+
+        if (done) {
+            break;
+        }
+
+        if (candidate_lowers_score(search, &search->candidates[index])) {
+            pthread_mutex_lock(&search->lock);
+            if (index < search->best) {
+                search->best = index;
+            }
+            pthread_mutex_unlock(&search->lock);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+* Multi-threaded version of find_lower_score. All edge cells are evaluated
+* concurrently, and the lowest indexed hit (in the serial top, right, bottom,
+* left order) is chosen, so the move is the same one find_lower_score picks.
+* @param board the main game board struct
+* @param player the player who is making the move
+* @param numThreads the number of threads to evaluate the edges with
+* @returns the coordinates of the first edge found that lowers the score of
+* the other player, or row and column both = -1 if there isn't one
+*/
+Coordinates find_lower_score_parallel(Board* board, PlayerTurn player,
+        int numThreads) {
+
+    Coordinates coords;
+    coords.row = -1;
+    coords.column = -1;
+
+    CandidateSearch search;
+    search.board = board;
+    search.otherPlayer = player ^ 1;
+    search.prePushScore = calculate_score(board, search.otherPlayer);
+    search.candidates = malloc(sizeof(EdgeCandidate)
+            * 2 * (board->width + board->height));
+    check_allocated_memory(search.candidates);
+    search.numCandidates = list_edge_candidates(board, search.candidates);
+    search.next = 0;
+    search.best = search.numCandidates; // i.e. nothing found yet
+    pthread_mutex_init(&search.lock, NULL);
+
+    if (numThreads > search.numCandidates) {
+        numThreads = search.numCandidates;
+    }
+
+    // this thread evaluates candidates too, so start one less
+    pthread_t threads[MAX_THREADS];
+    int numStarted = 0;
+    for (int i = 0; i < numThreads - 1; i++) {
+        if (pthread_create(&threads[numStarted], NULL, evaluate_candidates,
+                &search) == 0) {
+            numStarted++;
+        }
+    }
+
+    evaluate_candidates(&search);
+
+    for (int i = 0; i < numStarted; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    if (search.best < search.numCandidates) {
+        coords = search.candidates[search.best].edge;
+    }
+
+    pthread_mutex_destroy(&search.lock);
+    free(search.candidates);
+
+    return coords;
+}
@@ -0,0 +1,5 @@
+#include "types.h"
+
+int get_computer_threads(void);
+Coordinates find_lower_score_parallel(Board* board, PlayerTurn player,
+        int numThreads);
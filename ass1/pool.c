@@ -0,0 +1,147 @@
+/**
+ * This file handles the worker threads that push2310-server uses to work
+ * out computer moves, so that a slow search never blocks the event loop.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include "types.h"
+#include "utility.h"
+#include "computer.h"
+#include "pool.h"
+
+/**
+ * Worker thread; works out queued moves until the pool is stopped
+ * @param arg the WorkerPool
+ * @returns NULL
+ */
+void* move_worker(void* arg) {
+
+    WorkerPool* pool = arg;
+    uint64_t one = 1;
+
+    pthread_mutex_lock(&pool->lock);
+    while (true) {
+        while (pool->todoHead == NULL && !pool->stopping) {
+            pthread_cond_wait(&pool->ready, &pool->lock);
+        }
+        if (pool->stopping) {
+            break;
+        }
+
+        MoveJob* job = pool->todoHead;
+        pool->todoHead = job->next;
+        if (pool->todoHead == NULL) {
+            pool->todoTail = NULL;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        job->move = get_computer_input(job->board, job->playerTurn,
+                job->type);
+
+        pthread_mutex_lock(&pool->lock);
+        job->next = pool->finished;
+        pool->finished = job;
+        // the counter can't overflow in practice, so this can't fail
+        if (write(pool->eventFd, &one, sizeof(one)) < 0) {
+            perror("eventfd");
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/**
+ * Starts the worker threads
+ * @param pool the pool to start
+ * @param numThreads how many workers to run
+ */
+void start_workers(WorkerPool* pool, int numThreads) {
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->ready, NULL);
+    pool->todoHead = NULL;
+    pool->todoTail = NULL;
+    pool->finished = NULL;
+    pool->stopping = false;
+
+    if ((pool->eventFd = eventfd(0, EFD_NONBLOCK)) == -1) {
+        perror("eventfd");
+        exit(2);
+    }
+
+    pool->numThreads = numThreads;
+    pool->threads = malloc(sizeof(pthread_t) * numThreads);
+    check_allocated_memory(pool->threads);
+    for (int i = 0; i < numThreads; i++) {
+        pthread_create(&pool->threads[i], NULL, move_worker, pool);
+    }
+}
+
+/**
+ * Queues a computer move to be worked out
+ * @param pool the pool
+ * @param job the move, which belongs to the pool until it is finished
+ */
+void submit_move(WorkerPool* pool, MoveJob* job) {
+
+    job->next = NULL;
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->todoTail == NULL) {
+        pool->todoHead = job;
+    } else {
+        pool->todoTail->next = job;
+    }
+    pool->todoTail = job;
+    pthread_cond_signal(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/**
+ * Takes every finished move, and resets the eventfd
+ * @param pool the pool
+ * @returns the finished jobs, linked through next, or NULL if none
+ */
+MoveJob* take_finished_moves(WorkerPool* pool) {
+
+    uint64_t count;
+
+    pthread_mutex_lock(&pool->lock);
+    MoveJob* finished = pool->finished;
+    pool->finished = NULL;
+    if (read(pool->eventFd, &count, sizeof(count)) < 0) {
+        // nothing was signalled; fine, as the list was taken anyway
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return finished;
+}
+
+/**
+ * Stops and joins the workers. Jobs still queued are never worked out.
+ * @param pool the pool
+ */
+void stop_workers(WorkerPool* pool) {
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->numThreads; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    free(pool->threads);
+    close(pool->eventFd);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->ready);
+}
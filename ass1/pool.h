@@ -0,0 +1,44 @@
+#ifndef POOL
+#define POOL
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "types.h"
+
+/**
+ * A computer move for a worker to work out. The board must not be changed
+ * until the job comes back from take_finished_moves.
+ */
+typedef struct MoveJob {
+
+    struct MoveJob* next; // the next job in the same queue
+    void* owner; // whatever submitted the job, for the caller's use
+    Board* board; // the position to move in
+    PlayerTurn playerTurn; // the player to move
+    PlayerType type; // which computer player to use
+    Coordinates move; // filled in by the worker
+} MoveJob;
+
+/**
+ * Threads working out computer moves. Finished jobs are signalled on an
+ * eventfd, so an event loop can wait for them along with its sockets.
+ */
+typedef struct WorkerPool {
+
+    pthread_mutex_t lock; // protects everything below
+    pthread_cond_t ready; // signalled when a job is queued, or on stop
+    MoveJob* todoHead; // jobs waiting for a worker, oldest first
+    MoveJob* todoTail;
+    MoveJob* finished; // jobs that are done, in no particular order
+    bool stopping; // set to make the workers exit
+    int eventFd; // becomes readable when there are finished jobs
+    int numThreads;
+    pthread_t* threads;
+} WorkerPool;
+
+void start_workers(WorkerPool* pool, int numThreads);
+void submit_move(WorkerPool* pool, MoveJob* job);
+MoveJob* take_finished_moves(WorkerPool* pool);
+void stop_workers(WorkerPool* pool);
+
+#endif
@@ -0,0 +1,821 @@
+/**
+ * push2310-server hosts many games of push2310 at once, one per client
+ * connection, over TCP (on localhost) or a Unix socket. A single epoll loop
+ * handles every connection; computer moves are worked out by a pool of
+ * worker threads (pool.c) so they never hold up other games.
+ *
+ * The protocol is lines of text. Commands from the client:
+ *     load T1 T2 savefile  start a game from a savefile on the server,
+ *                          T1 and T2 are the player types (0, 1 or H)
+ *     place R C            make the human move R C
+ *     save savefile        save the game to a file on the server
+ * Savefiles are always in the server's savefile directory (-d, the current
+ * directory by default); names with a '/' or ".." in them are refused.
+ *     board                get the board, one line per row
+ *     quit                 close the connection
+ * Every command is answered with "ok" or "error <reason>" (the board rows
+ * come before the "ok"). As the game goes on the server also sends
+ *     move P R C           player P placed at R C
+ *     turn P               player P (a human) should send a place command
+ *     over Winners: W      the game finished, W as push2310 prints it
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include "types.h"
+#include "utility.h"
+#include "logic.h"
+#include "graphics.h"
+#include "computer.h"
+#include "parallel.h"
+#include "table.h"
+#include "book.h"
+#include "session.h"
+#include "pool.h"
+
+#define DEFAULT_WORKERS 4
+#define MAX_EVENTS 256 // the most epoll events handled per wakeup
+#define MAX_COMMAND_LINE 4096 // longer lines get the connection closed
+#define READ_CHUNK 4096
+#define BACKLOG 1024
+#define ACCEPT_RETRY_MS 100 // how often to retry accept when out of fds
+#define DEFAULT_DIRECTORY "."
+
+/**
+ * A client, and the game it is playing
+ */
+typedef struct Connection {
+
+    int fd; // the socket, or -1 once it has been closed
+    Session session;
+    char* in; // bytes received but not yet handled
+    size_t inLength;
+    size_t inCapacity;
+    char* out; // bytes waiting to be sent
+    size_t outLength;
+    size_t outSent; // how much of out has been sent
+    size_t outCapacity;
+    bool wantWrite; // whether epoll is watching for EPOLLOUT
+    bool peerClosed; // the client has stopped sending
+    bool busy; // a computer move is being worked out for this game
+    MoveJob job; // the computer move, while busy
+    bool closed; // on the server's list of connections to free
+    struct Connection* nextClosed; // the next connection on that list
+} Connection;
+
+/**
+ * Everything the event loop needs
+ */
+typedef struct Server {
+
+    int listenFd;
+    int epollFd;
+    WorkerPool pool;
+    char* directory; // where clients' savefiles are loaded and saved
+    bool acceptPaused; // accept ran out of fds, listenFd isn't watched
+    Connection* closed; // closed during this batch of events, freed after
+} Server;
+
+/**
+ * Exit thrown when the server is given bad arguments
+ */
+void exit_server_usage(void) {
+
+    fprintf(stderr, "%s", "Usage: push2310-server [-w workers] "
+            "[-d savefiledir] (-p port | -u socketpath)\n");
+    exit(1);
+}
+
+/**
+ * Makes a file descriptor non-blocking
+ * @param fd the file descriptor
+ */
+void set_non_blocking(int fd) {
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+/**
+ * Creates a listening TCP socket on localhost, and prints its port
+ * @param port the port to listen on, "0" for any free port
+ * @returns the socket
+ */
+int listen_tcp(char* port) {
+
+    struct addrinfo* ai = NULL;
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    int err;
+    if ((err = getaddrinfo("localhost", port, &hints, &ai))) {
+        fprintf(stderr, "%s\n", gai_strerror(err));
+        exit(2);
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        exit(2);
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen)) {
+        perror("bind");
+        exit(2);
+    }
+    freeaddrinfo(ai);
+
+    struct sockaddr_in address;
+    socklen_t length = sizeof(address);
+    if (getsockname(fd, (struct sockaddr*) &address, &length)) {
+        perror("getsockname");
+        exit(2);
+    }
+    printf("%u\n", ntohs(address.sin_port));
+    fflush(stdout);
+
+    return fd;
+}
+
+/**
+ * Creates a listening Unix socket, replacing any old socket file
+ * @param path where to create the socket
+ * @returns the socket
+ */
+int listen_unix(char* path) {
+
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        exit_server_usage();
+    }
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        perror("socket");
+        exit(2);
+    }
+    if (bind(fd, (struct sockaddr*) &address, sizeof(address))) {
+        perror("bind");
+        exit(2);
+    }
+
+    return fd;
+}
+
+/**
+ * Changes which events epoll reports for a connection
+ * @param server the server
+ * @param connection the connection
+ * @param wantWrite whether to watch for the socket becoming writable
+ */
+void watch_connection(Server* server, Connection* connection,
+        bool wantWrite) {
+
+    struct epoll_event event;
+    event.events = (connection->peerClosed ? 0 : EPOLLIN)
+            | (wantWrite ? EPOLLOUT : 0);
+    event.data.ptr = connection;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, connection->fd, &event);
+    connection->wantWrite = wantWrite;
+}
+
+/**
+ * Stops reading from a connection, once the client has finished sending
+ * (otherwise epoll would keep reporting the end of file)
+ * @param server the server
+ * @param connection the connection
+ */
+void stop_reading(Server* server, Connection* connection) {
+
+    connection->peerClosed = true;
+    watch_connection(server, connection, connection->wantWrite);
+}
+
+/**
+ * Starts or stops watching the listening socket for new clients
+ * @param server the server
+ * @param paused true to stop accepting, false to start again
+ */
+void pause_accepting(Server* server, bool paused) {
+
+    struct epoll_event event;
+    event.events = paused ? 0 : EPOLLIN;
+    event.data.ptr = &server->listenFd;
+    epoll_ctl(server->epollFd, EPOLL_CTL_MOD, server->listenFd, &event);
+    server->acceptPaused = paused;
+}
+
+/**
+ * Closes a connection. The socket is closed now, but the connection is
+ * only freed by free_closed_connections, after the current batch of epoll
+ * events (which may still point at it) has been handled. If a computer
+ * move is still being worked out it isn't freed until the move comes back.
+ * @param server the server
+ * @param connection the connection to close
+ */
+void close_connection(Server* server, Connection* connection) {
+
+    if (connection->fd != -1) {
+        epoll_ctl(server->epollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+        close(connection->fd);
+        connection->fd = -1;
+        if (server->acceptPaused) {
+            pause_accepting(server, false); // there's an fd free now
+        }
+    }
+
+    if (connection->busy || connection->closed) {
+        return;
+    }
+
+    connection->closed = true;
+    connection->nextClosed = server->closed;
+    server->closed = connection;
+}
+
+/**
+ * Frees the connections closed during the last batch of events
+ * @param server the server
+ */
+void free_closed_connections(Server* server) {
+
+    while (server->closed != NULL) {
+        Connection* connection = server->closed;
+        server->closed = connection->nextClosed;
+        free_session(&connection->session);
+        free(connection->in);
+        free(connection->out);
+        free(connection);
+    }
+}
+
+/**
+ * Sends as much of the connection's output as the socket will take
+ * @param server the server
+ * @param connection the connection
+ * @returns false if the connection had to be closed
+ */
+bool flush_connection(Server* server, Connection* connection) {
+
+    while (connection->outSent < connection->outLength) {
+        ssize_t sent = send(connection->fd,
+                connection->out + connection->outSent,
+                connection->outLength - connection->outSent, MSG_NOSIGNAL);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!connection->wantWrite) {
+                watch_connection(server, connection, true);
+            }
+            return true;
+        }
+        if (sent < 0 && errno != EINTR) {
+            close_connection(server, connection);
+            return false;
+        }
+        if (sent > 0) {
+            connection->outSent += sent;
+        }
+    }
+
+    connection->outLength = 0;
+    connection->outSent = 0;
+    if (connection->wantWrite) {
+        watch_connection(server, connection, false);
+    }
+    return true;
+}
+
+/**
+ * Queues text to be sent on a connection. Sending happens in
+ * flush_connection.
+ * @param connection the connection
+ * @param text the text to send
+ * @param length the number of bytes of text
+ */
+void send_text(Connection* connection, const char* text, size_t length) {
+
+    if (connection->outLength + length > connection->outCapacity) {
+        size_t capacity = connection->outCapacity * 2 + length;
+        connection->out = realloc(connection->out, capacity);
+        check_allocated_memory(connection->out);
+        connection->outCapacity = capacity;
+    }
+
+    memcpy(connection->out + connection->outLength, text, length);
+    connection->outLength += length;
+}
+
+/**
+ * Queues a formatted line to be sent on a connection
+ * @param connection the connection
+ * @param format printf format for the line, without the '\n'
+ */
+void send_line(Connection* connection, const char* format, ...) {
+
+    char line[MAX_COMMAND_LINE];
+    va_list args;
+
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line) - 1, format, args);
+    va_end(args);
+
+    if (length > (int) sizeof(line) - 2) {
+        length = sizeof(line) - 2;
+    }
+    line[length++] = '\n';
+    send_text(connection, line, length);
+}
+
+/**
+ * Queues the board to be sent, one line per row
+ * @param connection the connection
+ */
+void send_board(Connection* connection) {
+
+    char* text;
+    size_t length;
+    FILE* stream = open_memstream(&text, &length);
+
+    check_allocated_memory(stream);
+    write_board(stream, &connection->session.board);
+    fclose(stream);
+    send_text(connection, text, length);
+    free(text);
+}
+
+/**
+ * Moves the game on until it needs something: a human move, a computer
+ * move from the workers, or nothing because the game is over
+ * @param server the server
+ * @param connection the connection whose game to move on
+ */
+void advance_game(Server* server, Connection* connection) {
+
+    Session* session = &connection->session;
+    char symbol = player_enum_to_symbol(session->playerTurn);
+
+    if (session->gameOver) {
+        send_line(connection, "over Winners: %s",
+                calculate_winner(&session->board));
+        return;
+    }
+
+    if (session_player_type(session) == HUMAN) {
+        send_line(connection, "turn %c", symbol);
+        return;
+    }
+
+    connection->busy = true;
+    connection->job.owner = connection;
+    connection->job.board = &session->board;
+    connection->job.playerTurn = session->playerTurn;
+    connection->job.type = session_player_type(session);
+    submit_move(&server->pool, &connection->job);
+}
+
+/**
+ * Plays a move in a connection's game and tells the client
+ * @param connection the connection
+ * @param coords the move
+ */
+void play_move(Connection* connection, Coordinates coords) {
+
+    Session* session = &connection->session;
+    char symbol = player_enum_to_symbol(session->playerTurn);
+
+    session_play(session, coords);
+    send_line(connection, "move %c %d %d", symbol, coords.row,
+            coords.column);
+}
+
+/**
+ * Converts a whole string to an int
+ * @param text the string
+ * @param value where to put the int
+ * @returns false if text isn't an int
+ */
+bool parse_number(char* text, int* value) {
+
+    char* end;
+
+    if (text == NULL) {
+        return false;
+    }
+    long number = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || number < -1000000000L
+            || number > 1000000000L) {
+        return false;
+    }
+
+    *value = (int) number;
+    return true;
+}
+
+/**
+ * Works out where a savefile named by a client is. Clients can only name
+ * files directly inside the server's savefile directory.
+ * @param server the server
+ * @param fileName the name the client gave
+ * @returns the path, to be freed, or NULL if the name isn't allowed
+ */
+char* savefile_path(Server* server, char* fileName) {
+
+    if (strchr(fileName, '/') != NULL || strstr(fileName, "..") != NULL) {
+        return NULL;
+    }
+
+    size_t size = strlen(server->directory) + strlen(fileName) + 2;
+    char* path = malloc(size);
+    check_allocated_memory(path);
+    snprintf(path, size, "%s/%s", server->directory, fileName);
+    return path;
+}
+
+/**
+ * Handles the save command
+ * @param server the server
+ * @param connection the connection
+ * @param arguments the rest of the command line, tokenised by strtok_r
+ */
+void command_save(Server* server, Connection* connection, char** arguments) {
+
+    char* fileName = strtok_r(NULL, "", arguments);
+    char* path;
+
+    if (fileName == NULL || !connection->session.loaded) {
+        send_line(connection, "error usage: save savefile");
+    } else if ((path = savefile_path(server, fileName)) == NULL) {
+        send_line(connection, "error bad savefile name");
+    } else {
+        if (!save_session(&connection->session, path)) {
+            send_line(connection, "error can't save");
+        } else {
+            send_line(connection, "ok");
+        }
+        free(path);
+    }
+}
+
+/**
+ * Handles the load command
+ * @param server the server
+ * @param connection the connection
+ * @param arguments the rest of the command line, tokenised by strtok_r
+ */
+void command_load(Server* server, Connection* connection, char** arguments) {
+
+    char* naughtType = strtok_r(NULL, " ", arguments);
+    char* crossType = strtok_r(NULL, " ", arguments);
+    char* fileName = strtok_r(NULL, "", arguments);
+
+    if (fileName == NULL || !check_valid_player_type(naughtType)
+            || !check_valid_player_type(crossType)) {
+        send_line(connection, "error usage: load T1 T2 savefile");
+        return;
+    }
+
+    char* path = savefile_path(server, fileName);
+    if (path == NULL) {
+        send_line(connection, "error bad savefile name");
+        return;
+    }
+
+    const char* reason = load_session(&connection->session, path,
+            string_to_player_type(naughtType),
+            string_to_player_type(crossType));
+    free(path);
+    if (reason != NULL) {
+        send_line(connection, "error %s", reason);
+        return;
+    }
+
+    send_line(connection, "ok");
+    advance_game(server, connection);
+}
+
+/**
+ * Handles the place command
+ * @param server the server
+ * @param connection the connection
+ * @param arguments the rest of the command line, tokenised by strtok_r
+ */
+void command_place(Server* server, Connection* connection,
+        char** arguments) {
+
+    Session* session = &connection->session;
+    Coordinates coords;
+
+    if (!parse_number(strtok_r(NULL, " ", arguments), &coords.row)
+            || !parse_number(strtok_r(NULL, " ", arguments), &coords.column)
+            || strtok_r(NULL, " ", arguments) != NULL) {
+        send_line(connection, "error usage: place R C");
+    } else if (!session->loaded) {
+        send_line(connection, "error no game loaded");
+    } else if (session->gameOver) {
+        send_line(connection, "error game over");
+    } else if (!session_valid_move(session, coords)) {
+        send_line(connection, "error invalid move");
+    } else {
+        send_line(connection, "ok");
+        play_move(connection, coords);
+        advance_game(server, connection);
+    }
+}
+
+/**
+ * Handles one command line from a client
+ * @param server the server
+ * @param connection the connection the command came from
+ * @param line the command, without its '\n'
+ * @returns false if the client quit
+ */
+bool handle_command(Server* server, Connection* connection, char* line) {
+
+    Session* session = &connection->session;
+    char* arguments;
+    char* command = strtok_r(line, " ", &arguments);
+
+    if (command == NULL) {
+        send_line(connection, "error empty command");
+    } else if (strcmp(command, "load") == 0) {
+        command_load(server, connection, &arguments);
+    } else if (strcmp(command, "place") == 0) {
+        command_place(server, connection, &arguments);
+    } else if (strcmp(command, "save") == 0) {
+        command_save(server, connection, &arguments);
+    } else if (strcmp(command, "board") == 0) {
+        if (!session->loaded) {
+            send_line(connection, "error no game loaded");
+        } else {
+            send_board(connection);
+            send_line(connection, "ok");
+        }
+    } else if (strcmp(command, "quit") == 0) {
+        return false;
+    } else {
+        send_line(connection, "error unknown command");
+    }
+
+    return true;
+}
+
+/**
+ * Handles every complete command line a connection has sent, stopping
+ * early if a computer move has to be worked out first. Closes the
+ * connection when the client has finished and everything has been sent.
+ * @param server the server
+ * @param connection the connection
+ */
+void handle_commands(Server* server, Connection* connection) {
+
+    size_t start = 0;
+    char* newline;
+
+    while (!connection->busy && (newline = memchr(connection->in + start,
+            '\n', connection->inLength - start)) != NULL) {
+        *newline = '\0';
+        if (newline > connection->in + start && newline[-1] == '\r') {
+            newline[-1] = '\0';
+        }
+        char* line = connection->in + start;
+        start = newline + 1 - connection->in;
+        if (!handle_command(server, connection, line)) {
+            // ignore anything after quit, close once the output is sent
+            start = connection->inLength;
+            stop_reading(server, connection);
+            break;
+        }
+    }
+
+    connection->inLength -= start;
+    memmove(connection->in, connection->in + start, connection->inLength);
+
+    if (connection->inLength > MAX_COMMAND_LINE) {
+        send_line(connection, "error command too long");
+        connection->inLength = 0;
+        stop_reading(server, connection);
+    }
+
+    if (!flush_connection(server, connection)) {
+        return;
+    }
+    if (connection->peerClosed && !connection->busy
+            && connection->outLength == 0) {
+        close_connection(server, connection);
+    }
+}
+
+/**
+ * Reads everything available from a connection, then handles it
+ * @param server the server
+ * @param connection the connection
+ */
+void read_connection(Server* server, Connection* connection) {
+
+    while (!connection->peerClosed) {
+        if (connection->inCapacity - connection->inLength < READ_CHUNK) {
+            connection->inCapacity = connection->inCapacity * 2 + READ_CHUNK;
+            connection->in = realloc(connection->in, connection->inCapacity);
+            check_allocated_memory(connection->in);
+        }
+        ssize_t got = read(connection->fd,
+                connection->in + connection->inLength,
+                connection->inCapacity - connection->inLength);
+        if (got > 0) {
+            connection->inLength += got;
+        } else if (got == 0) {
+            stop_reading(server, connection);
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        } else if (errno != EINTR) {
+            close_connection(server, connection);
+            return;
+        }
+    }
+
+    handle_commands(server, connection);
+}
+
+/**
+ * Accepts every waiting client. If the process (or system) is out of file
+ * descriptors the listening socket stops being watched, otherwise epoll
+ * would keep reporting it; see pause_accepting.
+ * @param server the server
+ */
+void accept_connections(Server* server) {
+
+    int fd;
+
+    while ((fd = accept(server->listenFd, NULL, NULL)) != -1
+            || errno == EINTR || errno == ECONNABORTED) {
+        if (fd == -1) {
+            continue;
+        }
+        set_non_blocking(fd);
+
+        Connection* connection = calloc(1, sizeof(Connection));
+        check_allocated_memory(connection);
+        connection->fd = fd;
+        init_session(&connection->session);
+
+        struct epoll_event event;
+        event.events = EPOLLIN;
+        event.data.ptr = connection;
+        epoll_ctl(server->epollFd, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS
+            || errno == ENOMEM) {
+        pause_accepting(server, true);
+    }
+}
+
+/**
+ * Plays the computer moves the workers have finished, and moves each of
+ * those games on
+ * @param server the server
+ */
+void finish_computer_moves(Server* server) {
+
+    MoveJob* job = take_finished_moves(&server->pool);
+
+    while (job != NULL) {
+        MoveJob* next = job->next;
+        Connection* connection = job->owner;
+        connection->busy = false;
+
+        if (connection->fd == -1) {
+            close_connection(server, connection); // client already left
+        } else {
+            play_move(connection, job->move);
+            advance_game(server, connection);
+            handle_commands(server, connection);
+        }
+
+        job = next;
+    }
+}
+
+/**
+ * Reads the server's arguments and creates its listening socket
+ * @param argc the number of arguments
+ * @param argv the arguments
+ * @param numWorkers where to put the number of worker threads
+ * @param directory where to put the savefile directory
+ * @returns the listening socket
+ */
+int parse_server_args(int argc, char** argv, int* numWorkers,
+        char** directory) {
+
+    char* port = NULL;
+    char* path = NULL;
+    int option;
+
+    *numWorkers = DEFAULT_WORKERS;
+    *directory = DEFAULT_DIRECTORY;
+    while ((option = getopt(argc, argv, "w:d:p:u:")) != -1) {
+        switch (option) {
+            case 'w':
+                *numWorkers = atoi(optarg);
+                break;
+            case 'd':
+                *directory = optarg;
+                break;
+            case 'p':
+                port = optarg;
+                break;
+            case 'u':
+                path = optarg;
+                break;
+            default:
+                exit_server_usage();
+        }
+    }
+
+    if (optind != argc || (port == NULL) == (path == NULL)
+            || *numWorkers < 1) {
+        exit_server_usage();
+    }
+
+    return (port != NULL) ? listen_tcp(port) : listen_unix(path);
+}
+
+int main(int argc, char** argv) {
+
+    Server server;
+    int numWorkers;
+    struct epoll_event events[MAX_EVENTS];
+
+    server.listenFd = parse_server_args(argc, argv, &numWorkers,
+            &server.directory);
+    server.acceptPaused = false;
+    server.closed = NULL;
+    if (listen(server.listenFd, BACKLOG)) {
+        perror("listen");
+        exit(2);
+    }
+    set_non_blocking(server.listenFd);
+    signal(SIGPIPE, SIG_IGN);
+
+    get_computer_threads(); // read the environment before workers start
+    open_table(); // only does anything if PUSH2310_TABLE is set
+    open_book(); // only does anything if PUSH2310_BOOK is set
+    start_workers(&server.pool, numWorkers);
+
+    // the listening socket and eventfd are told apart from connections
+    // by pointing at their own file descriptors
+    server.epollFd = epoll_create1(0);
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = &server.listenFd;
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.listenFd, &event);
+    event.data.ptr = &server.pool.eventFd;
+    epoll_ctl(server.epollFd, EPOLL_CTL_ADD, server.pool.eventFd, &event);
+
+    while (true) {
+        // while out of fds, try accepting again every so often in case
+        // they were freed by something other than a connection closing
+        int numEvents = epoll_wait(server.epollFd, events, MAX_EVENTS,
+                server.acceptPaused ? ACCEPT_RETRY_MS : -1);
+        if (numEvents == 0 && server.acceptPaused) {
+            pause_accepting(&server, false);
+        }
+        for (int i = 0; i < numEvents; i++) {
+            void* source = events[i].data.ptr;
+            if (source == &server.listenFd) {
+                accept_connections(&server);
+            } else if (source == &server.pool.eventFd) {
+                finish_computer_moves(&server);
+            } else if (((Connection*) source)->fd == -1) {
+                continue; // closed earlier in this batch
+            } else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                read_connection(&server, source);
+            } else if (events[i].events & EPOLLOUT) {
+                handle_commands(&server, source);
+            }
+        }
+        free_closed_connections(&server);
+    }
+
+    return 0;
+}
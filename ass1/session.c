@@ -0,0 +1,130 @@
+/**
+ * This file handles the state of one game in push2310-server. It does the
+ * same things as the main loop in main.c, one move at a time.
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "types.h"
+#include "utility.h"
+#include "load.h"
+#include "engine.h"
+#include "session.h"
+
+#define MAX_SESSION_CELLS 4000000 // the largest board a session will load
+
+/**
+ * Sets up a session with no game loaded
+ * @param session the session
+ */
+void init_session(Session* session) {
+
+    session->loaded = false;
+    session->gameOver = false;
+}
+
+/**
+ * Loads a savefile into a session, replacing any game already loaded
+ * @param session the session
+ * @param fileName the savefile to load
+ * @param naughtType the type of player O
+ * @param crossType the type of player X
+ * @returns NULL if the game was loaded, otherwise why it wasn't
+ */
+const char* load_session(Session* session, char* fileName,
+        PlayerType naughtType, PlayerType crossType) {
+
+    FILE* file;
+    Board board;
+    PlayerTurn playerTurn;
+
+    if ((file = fopen(fileName, "r")) == NULL) {
+        return "can't open savefile";
+    }
+
+    LoadStatus status = read_savefile(file, &board, &playerTurn,
+            MAX_SESSION_CELLS);
+    fclose(file);
+    if (status != LOAD_OK) {
+        return load_status_message(status);
+    }
+
+    free_session(session);
+    session->board = board;
+    session->engine = select_engine(&session->board);
+    session->types[PLAYER_O_TURN] = naughtType;
+    session->types[PLAYER_X_TURN] = crossType;
+    session->playerTurn = playerTurn;
+    session->gameOver = false;
+    session->loaded = true;
+    return NULL;
+}
+
+/**
+ * Gets the type of the player whose turn it is
+ * @param session the session
+ * @returns the player type
+ */
+PlayerType session_player_type(Session* session) {
+
+    return session->types[session->playerTurn];
+}
+
+/**
+ * Checks a human's move, like get_player_input does
+ * @param session the session
+ * @param coords where the player wants to place
+ * @returns true if the move is valid
+ */
+bool session_valid_move(Session* session, Coordinates coords) {
+
+    return session->engine.valid_placement(session->engine.state, coords);
+}
+
+/**
+ * Plays a move for the player whose turn it is, then passes the turn on
+ * @param session the session
+ * @param coords where to place, already known to be valid
+ */
+void session_play(Session* session, Coordinates coords) {
+
+    Engine* engine = &session->engine;
+
+    engine->play(engine->state, session->playerTurn, coords);
+    engine->sync(engine->state, &session->board);
+    session->playerTurn ^= 1;
+    session->gameOver = engine->game_over(engine->state);
+}
+
+/**
+ * Saves the session's game, like the human save command
+ * @param session the session
+ * @param fileName the file to save to
+ * @returns false if the file couldn't be written
+ */
+bool save_session(Session* session, char* fileName) {
+
+    FILE* file;
+
+    if ((file = fopen(fileName, "w")) == NULL) {
+        return false;
+    }
+
+    write_savefile(file, &session->board, session->playerTurn);
+    return fclose(file) == 0;
+}
+
+/**
+ * Frees the session's game, if one is loaded
+ * @param session the session
+ */
+void free_session(Session* session) {
+
+    if (!session->loaded) {
+        return;
+    }
+
+    free_engine(&session->engine);
+    free_board(&session->board);
+    session->loaded = false;
+}
@@ -0,0 +1,30 @@
+#ifndef SESSION
+#define SESSION
+
+#include <stdbool.h>
+#include "types.h"
+#include "engine.h"
+
+/**
+ * One game hosted by push2310-server
+ */
+typedef struct Session {
+
+    bool loaded; // false until a savefile has been loaded
+    bool gameOver;
+    Board board; // what gets printed and saved, and what computers search
+    Engine engine; // applies moves; fixed size boards get a compact engine
+    PlayerType types[2]; // player O's type, then player X's
+    PlayerTurn playerTurn;
+} Session;
+
+void init_session(Session* session);
+const char* load_session(Session* session, char* fileName,
+        PlayerType naughtType, PlayerType crossType);
+PlayerType session_player_type(Session* session);
+bool session_valid_move(Session* session, Coordinates coords);
+void session_play(Session* session, Coordinates coords);
+bool save_session(Session* session, char* fileName);
+void free_session(Session* session);
+
+#endif
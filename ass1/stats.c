@@ -0,0 +1,131 @@
+/**
+ * This file handles reporting the hot path counters declared in stats.h.
+ * The summary is written to stderr when the program exits, or whenever it
+ * is sent SIGUSR1.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include "stats.h"
+
+#ifdef PUSH2310_STATS
+
+#define MAX_STAT_LINE 128 // long enough for any line of the summary
+
+Stats stats; // zero initialised as it's global
+
+/**
+ * Gets the current time from a monotonic clock
+ * @returns nanoseconds since some fixed point
+ */
+uint64_t stats_now(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * Records a push of length cells
+ * @param length the number of cells that moved
+ */
+void stats_record_push(uint64_t length) {
+
+    STAT_ADD(pushes, 1);
+    STAT_ADD(pushCells, length);
+
+    uint64_t longest = __atomic_load_n(&stats.longestPush, __ATOMIC_RELAXED);
+    while (length > longest && !__atomic_compare_exchange_n(
+            &stats.longestPush, &longest, length, true,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        // longest now holds the latest value, try again
+    }
+}
+
+/**
+ * Writes one line of the summary to stderr. Only uses write(), so this is
+ * safe to call from a signal handler (unlike printf).
+ * @param name the name of the statistic
+ * @param value the value of the statistic
+ */
+void write_stat(const char* name, uint64_t value) {
+
+    char line[MAX_STAT_LINE];
+    char digits[20]; // enough for any uint64_t
+    size_t length = strlen(name);
+    int numDigits = 0;
+
+    memcpy(line, name, length);
+    do {
+        digits[numDigits++] = '0' + value % 10;
+        value /= 10;
+    } while (value != 0);
+    while (numDigits > 0) {
+        line[length++] = digits[--numDigits];
+    }
+    line[length++] = '\n';
+
+    // nothing sensible can be done if stderr can't be written to
+    if (write(STDERR_FILENO, line, length) < 0) {
+        return;
+    }
+}
+
+/**
+ * Writes the summary of all the statistics to stderr
+ */
+void dump_stats(void) {
+
+    const char* typeNames[NUM_PLAYER_TYPES] = {"0", "1", "H"};
+    char name[MAX_STAT_LINE];
+
+    write_stat("check_valid_placement calls: ", stats.validPlacementCalls);
+    write_stat("pushes: ", stats.pushes);
+    write_stat("cells pushed: ", stats.pushCells);
+    write_stat("longest push: ", stats.longestPush);
+    write_stat("copy_board calls: ", stats.copyBoardCalls);
+    write_stat("copy_board bytes: ", stats.copyBoardBytes);
+    write_stat("calculate_score calls: ", stats.calculateScoreCalls);
+    for (int i = 0; i < NUM_PLAYER_TYPES; i++) {
+        strcpy(name, "handle_move type ");
+        strcat(name, typeNames[i]);
+        strcat(name, " moves: ");
+        write_stat(name, stats.moves[i]);
+        strcpy(name, "handle_move type ");
+        strcat(name, typeNames[i]);
+        strcat(name, " us: ");
+        write_stat(name, stats.moveNanos[i] / 1000);
+    }
+}
+
+/**
+ * SIGUSR1 handler; dumps the statistics so far
+ * @param s the signal number
+ */
+void handle_stats_signal(int s) {
+
+    dump_stats();
+}
+
+#endif
+
+/**
+ * Sets up the statistics to be dumped on exit and on SIGUSR1.
+ * Does nothing unless compiled with PUSH2310_STATS.
+ */
+void init_stats(void) {
+
+#ifdef PUSH2310_STATS
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stats_signal;
+    sa.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &sa, 0);
+    atexit(dump_stats);
+#endif
+}
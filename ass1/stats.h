@@ -0,0 +1,57 @@
+#ifndef STATS
+#define STATS
+
+#include <stdint.h>
+#include "types.h"
+
+/**
+ * Counters and timers for the rules engine's hot paths.
+ * They only exist when compiled with -DPUSH2310_STATS (make STATS=1);
+ * otherwise every STAT_ macro expands to nothing.
+ */
+
+#define NUM_PLAYER_TYPES 3 // COMPUTER_ZERO, COMPUTER_ONE and HUMAN
+
+typedef struct Stats {
+
+    uint64_t validPlacementCalls; // calls to check_valid_placement
+    uint64_t pushes; // calls to push_vertical/push_horizontal that moved
+    uint64_t pushCells; // total cells moved by all those pushes
+    uint64_t longestPush; // the most cells moved by a single push
+    uint64_t copyBoardCalls; // calls to copy_board
+    uint64_t copyBoardBytes; // bytes allocated by copy_board
+    uint64_t calculateScoreCalls; // calls to calculate_score
+    uint64_t moves[NUM_PLAYER_TYPES]; // handle_move calls per player type
+    uint64_t moveNanos[NUM_PLAYER_TYPES]; // time in handle_move per type
+} Stats;
+
+void init_stats(void);
+
+#ifdef PUSH2310_STATS
+
+extern Stats stats;
+
+uint64_t stats_now(void);
+void stats_record_push(uint64_t length);
+
+// counters may be bumped from computer one's worker threads
+#define STAT_ADD(counter, amount) \
+        __atomic_fetch_add(&stats.counter, (amount), __ATOMIC_RELAXED)
+#define STAT_PUSH(length) stats_record_push(length)
+#define STAT_TIMER_START(timer) uint64_t timer = stats_now()
+#define STAT_TIMER_STOP(timer, type) \
+        do { \
+            STAT_ADD(moves[type], 1); \
+            STAT_ADD(moveNanos[type], stats_now() - (timer)); \
+        } while (0)
+
+#else
+
+#define STAT_ADD(counter, amount)
+#define STAT_PUSH(length)
+#define STAT_TIMER_START(timer)
+#define STAT_TIMER_STOP(timer, type)
+
+#endif
+
+#endif
@@ -0,0 +1,211 @@
+/**
+ * This file handles the transposition table computer players can share.
+ * The table lives in a file which is mmap'd, so any number of push2310
+ * processes can use it at once, and it's still there next time.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "types.h"
+#include "table.h"
+
+#define TABLE_VARIABLE "PUSH2310_TABLE" // env var with the table's file name
+#define TABLE_SIZE_VARIABLE "PUSH2310_TABLE_SIZE" // env var with num entries
+#define TABLE_MAGIC 0x3031333248535550ULL // "PUSH2310" in little endian
+#define DEFAULT_TABLE_ENTRIES (1 << 20)
+
+/**
+ * A single slot in the table.
+ * version is even when the slot is stable and odd while it's being written,
+ * so readers can tell if they raced with a writer (i.e. a seqlock)
+ */
+typedef struct TableEntry {
+
+    uint64_t version; // incremented before and after every write
+    uint64_t key; // hash of the position this slot holds
+    uint64_t move; // the row in the high 32 bits, column in the low 32 bits
+} TableEntry;
+
+/**
+ * The start of the table file
+ */
+typedef struct TableHeader {
+
+    uint64_t magic; // TABLE_MAGIC once the file has been initialised
+    uint64_t numEntries; // how many entries follow the header
+} TableHeader;
+
+static TableHeader* table = NULL; // the mapped file, NULL if not in use
+static TableEntry* entries = NULL; // the entries after the header
+static size_t tableBytes = 0; // the size of the mapping
+
+/**
+ * Locks or unlocks the whole table file, so only one process sets it up
+ * @param fd the table file
+ * @param type F_WRLCK to lock, F_UNLCK to unlock
+ */
+void lock_table_file(int fd, short type) {
+
+    struct flock lock;
+    memset(&lock, 0, sizeof(lock));
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    fcntl(fd, F_SETLKW, &lock);
+}
+
+/**
+ * Opens (creating if needed) the table file named by PUSH2310_TABLE.
+ * If the variable isn't set, the table can't be opened or the file isn't a
+ * table of the size its header says, the table just isn't used; it's only
+ * ever an optimisation.
+ */
+void open_table(void) {
+
+    char* fileName = getenv(TABLE_VARIABLE);
+    if (fileName == NULL || fileName[0] == '\0') {
+        return;
+    }
+
+    int fd = open(fileName, O_RDWR | O_CREAT, 0666);
+    if (fd == -1) {
+        return;
+    }
+
+    lock_table_file(fd, F_WRLCK);
+
+    struct stat info;
+    TableHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fstat(fd, &info) != 0) {
+        lock_table_file(fd, F_UNLCK);
+        close(fd);
+        return;
+    }
+
+    if (info.st_size == 0) {
+        // new file, set it up
+        char* size = getenv(TABLE_SIZE_VARIABLE);
+        header.magic = TABLE_MAGIC;
+        header.numEntries = (size == NULL) ? 0 : strtoull(size, NULL, 10);
+        if (header.numEntries == 0) {
+            header.numEntries = DEFAULT_TABLE_ENTRIES;
+        }
+        // ftruncate zero fills, and a zeroed entry is an empty slot
+        if (ftruncate(fd, sizeof(TableHeader)
+                + header.numEntries * sizeof(TableEntry)) != 0
+                || pwrite(fd, &header, sizeof(header), 0) != sizeof(header)) {
+            lock_table_file(fd, F_UNLCK);
+            close(fd);
+            return;
+        }
+    } else if ((uint64_t) info.st_size < sizeof(TableHeader)
+            || pread(fd, &header, sizeof(header), 0) != sizeof(header)
+            || header.magic != TABLE_MAGIC || header.numEntries == 0
+            || header.numEntries != (info.st_size - sizeof(TableHeader))
+            / sizeof(TableEntry)
+            || (info.st_size - sizeof(TableHeader)) % sizeof(TableEntry)) {
+        // someone else's (or a truncated) file: leave it alone, and don't
+        // map past its end
+        lock_table_file(fd, F_UNLCK);
+        close(fd);
+        return;
+    }
+
+    tableBytes = sizeof(TableHeader) + header.numEntries * sizeof(TableEntry);
+    void* mapping = mmap(NULL, tableBytes, PROT_READ | PROT_WRITE,
+            MAP_SHARED, fd, 0);
+
+    lock_table_file(fd, F_UNLCK);
+    close(fd); // the mapping stays valid after closing
+
+    if (mapping == MAP_FAILED) {
+        return;
+    }
+
+    table = (TableHeader*) mapping;
+    entries = (TableEntry*) (table + 1);
+}
+
+/**
+ * Unmaps the table, if one was opened
+ */
+void close_table(void) {
+
+    if (table != NULL) {
+        munmap(table, tableBytes);
+        table = NULL;
+        entries = NULL;
+    }
+}
+
+/**
+ * Looks up a position in the table
+ * @param key the hash of the position (see hash_board)
+ * @param coords set to the stored move if the position was found
+ * @returns true iff the position was in the table
+ */
+bool probe_table(uint64_t key, Coordinates* coords) {
+
+    if (table == NULL) {
+        return false;
+    }
+
+    TableEntry* entry = &entries[key % table->numEntries];
+
+    uint64_t before = __atomic_load_n(&entry->version, __ATOMIC_ACQUIRE);
+    if (before == 0 || (before & 1)) {
+        return false; // empty, or being written right now
+    }
+    uint64_t storedKey = __atomic_load_n(&entry->key, __ATOMIC_RELAXED);
+    uint64_t move = __atomic_load_n(&entry->move, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    uint64_t after = __atomic_load_n(&entry->version, __ATOMIC_RELAXED);
+
+    if (before != after || storedKey != key) {
+        return false;
+    }
+
+    coords->row = (int) (move >> 32);
+    coords->column = (int) (move & 0xFFFFFFFF);
+    return true;
+}
+
+/**
+ * Stores the move for a position in the table, replacing whatever was in
+ * that slot. If another process is writing the same slot, this store is
+ * dropped rather than waiting.
+ * @param key the hash of the position (see hash_board)
+ * @param coords the move to store
+ */
+void store_table(uint64_t key, Coordinates coords) {
+
+    if (table == NULL) {
+        return;
+    }
+
+    TableEntry* entry = &entries[key % table->numEntries];
+
+    uint64_t version = __atomic_load_n(&entry->version, __ATOMIC_RELAXED);
+    if ((version & 1) || !__atomic_compare_exchange_n(&entry->version,
+            &version, version + 1, false, __ATOMIC_ACQUIRE,
+            __ATOMIC_RELAXED)) {
+        return;
+    }
+    // make sure the odd version is visible before the new contents
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    uint64_t move = ((uint64_t) (uint32_t) coords.row << 32)
+            | (uint32_t) coords.column;
+    __atomic_store_n(&entry->key, key, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->move, move, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->version, version + 2, __ATOMIC_RELEASE);
+}
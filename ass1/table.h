@@ -0,0 +1,8 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include "types.h"
+
+void open_table(void);
+void close_table(void);
+bool probe_table(uint64_t key, Coordinates* coords);
+void store_table(uint64_t key, Coordinates coords);
@@ -16,13 +16,33 @@ typedef struct Game {
     PlayerType playerXType;
     PlayerTurn playerTurn;
     bool gameOver;
+    struct History* history; // moves played (history.h), NULL if no human
 } Game;
 
+typedef struct CellChange {
+
+    int row;
+    int column;
+    char before; // the cell's symbol before the change
+    char after; // the cell's symbol after the change
+} CellChange;
+
+typedef struct Journal {
+
+    CellChange* changes; // every symbol change since the journal was reset
+    int length;
+    int capacity;
+} Journal;
+
 typedef struct Board {
 
     int width;
     int height;
     char*** values;
+    int* emptyInRow; // the number of empty cells in each row
+    int* emptyInCol; // the number of empty cells in each column
+    int emptyInterior; // the number of empty cells in the interior
+    Journal* journal; // where set_symbol records changes, NULL if nowhere
 } Board;
 
 typedef struct Coordinates {
@@ -1,10 +1,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include "exit.h"
 #include "types.h"
 #include "utility.h"
+#include "stats.h"
+
+#define FNV_OFFSET 14695981039346656037ULL // FNV-1a 64 bit offset basis
+#define FNV_PRIME 1099511628211ULL // FNV-1a 64 bit prime
 
 /**
  * Checks to see if dynamically allocated memory is allocated properly.
@@ -72,20 +77,30 @@ PlayerTurn player_symbol_to_enum(char symbol) {
 
 /**
  * Frees the dynamically allocated memory for the board
+ * (see allocate_board_memory for how it's laid out)
  * @param the 3D array which contains for board values
  */
 void free_board_values(char*** values, int height, int width) {
 
-    for (int i = 0; i < height; i++) {
-        for (int j = 0; j < width; j++) {
-            free(values[i][j]);
-        }
-        free(values[i]);
-    }
-        
+    free(values[0][0]);
+    free(values[0]);
     free(values);
 }
 
+/**
+ * Frees the board values and the empty cell counters of a board
+ * @param board the board to be freed
+ */
+void free_board(Board* board) {
+
+    free_board_values(board->values, board->height, board->width);
+    free(board->emptyInRow);
+    free(board->emptyInCol);
+    board->values = NULL;
+    board->emptyInRow = NULL;
+    board->emptyInCol = NULL;
+}
+
 /**
  * Checks if the user supplied player type is valid
  * @param type the user supplied player type
@@ -116,23 +131,29 @@ PlayerType string_to_player_type(char* value) {
 }
 
 /**
- * Dynamically allocates the memory for the board values
+ * Dynamically allocates the memory for the board values.
+ * All the cells live in one block (and all the cell pointers in another),
+ * rather than one malloc per cell, so big boards are cheap to set up and copy
  * @param height the height of the board
  * @param width the width of the board
  * @returns dynamically allocated 3D array
  */
 char*** allocate_board_memory(int height, int width) {
 
+    size_t numCells = (size_t) height * width;
+
     char*** values = malloc(sizeof(char**) * height);
     check_allocated_memory(values);
+    char** cellPointers = malloc(sizeof(char*) * numCells);
+    check_allocated_memory(cellPointers);
+    // 3 since 2 characters + null terminator
+    char* cells = malloc(sizeof(char) * 3 * numCells);
+    check_allocated_memory(cells);
 
     for (int i = 0; i < height; i++) {
-        values[i] = malloc(sizeof(char*) * width);
-        check_allocated_memory(values[i]);
+        values[i] = cellPointers + (size_t) i * width;
         for (int j = 0; j < width; j++) {
-            // 3 since 2 characters + null terminator
-            values[i][j] = malloc(sizeof(char) * 3);
-            check_allocated_memory(values[i][j]);
+            values[i][j] = cells + 3 * ((size_t) i * width + j);
         }
     }
     
@@ -223,6 +244,10 @@ Coordinates get_adjacent_horizontal_cell
  */
 int sum_empty_cells_in_row(int row, Board* board) {
 
+    if (board->emptyInRow != NULL) {
+        return board->emptyInRow[row];
+    }
+
     int numEmpty = 0;
 
     for (int i = 0; i < board->width; i++) {
@@ -242,6 +267,10 @@ int sum_empty_cells_in_row(int row, Board* board) {
  */
 int sum_empty_cells_in_col(int col, Board* board) {
 
+    if (board->emptyInCol != NULL) {
+        return board->emptyInCol[col];
+    }
+
     int numEmpty = 0;
 
     for (int i = 0; i < board->height; i++) {
@@ -253,6 +282,91 @@ int sum_empty_cells_in_col(int col, Board* board) {
     return numEmpty;
 }
 
+/**
+ * Counts the empty cells in every row and column, and in the interior, so
+ * the rules never need to scan a whole line (or the whole board) again.
+ * Must be called once the board values are loaded; after that, all changes
+ * to symbols must go through set_symbol to keep the counts right.
+ * The board starts off not recording changes in a journal.
+ * @param board the main game board struct
+ */
+void count_empty_cells(Board* board) {
+
+    board->journal = NULL;
+
+    board->emptyInRow = calloc(board->height, sizeof(int));
+    check_allocated_memory(board->emptyInRow);
+    board->emptyInCol = calloc(board->width, sizeof(int));
+    check_allocated_memory(board->emptyInCol);
+    board->emptyInterior = 0;
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            if (board->values[i][j][1] != '.') {
+                continue;
+            }
+            board->emptyInRow[i]++;
+            board->emptyInCol[j]++;
+            if (i > 0 && i < board->height - 1
+                    && j > 0 && j < board->width - 1) {
+                board->emptyInterior++;
+            }
+        }
+    }
+}
+
+/**
+ * Adds a change to a journal
+ * @param journal the journal
+ * @param coords the cell that changed
+ * @param before the cell's old symbol
+ * @param after the cell's new symbol
+ */
+void record_change(Journal* journal, Coordinates coords, char before,
+        char after) {
+
+    if (journal->length == journal->capacity) {
+        journal->capacity = journal->capacity * 2 + 8;
+        journal->changes = realloc(journal->changes,
+                sizeof(CellChange) * journal->capacity);
+        check_allocated_memory(journal->changes);
+    }
+
+    CellChange* change = &journal->changes[journal->length++];
+    change->row = coords.row;
+    change->column = coords.column;
+    change->before = before;
+    change->after = after;
+}
+
+/**
+ * Sets the symbol (i.e. O, X or .) of a cell, keeping the empty cell counts
+ * up to date, and recording the change if the board has a journal
+ * @param coords the cell to change
+ * @param board the main game board struct
+ * @param symbol the new symbol for the cell
+ */
+void set_symbol(Coordinates coords, Board* board, char symbol) {
+
+    char* cell = board->values[coords.row][coords.column];
+    int change = (symbol == '.') - (cell[1] == '.'); // +1, -1 or 0
+
+    if (board->journal != NULL && cell[1] != symbol) {
+        record_change(board->journal, coords, cell[1], symbol);
+    }
+    cell[1] = symbol;
+
+    if (change == 0 || board->emptyInRow == NULL) {
+        return;
+    }
+
+    board->emptyInRow[coords.row] += change;
+    board->emptyInCol[coords.column] += change;
+    if (coords.row > 0 && coords.row < board->height - 1
+            && coords.column > 0 && coords.column < board->width - 1) {
+        board->emptyInterior += change;
+    }
+}
 
 /**
  * Places the appropriate marker at the location in board specified by coords
@@ -266,7 +380,7 @@ int sum_empty_cells_in_col(int col, Board* board) {
 void place_marker(PlayerTurn playerTurn, Coordinates coords, Board* board) {
     
     char marker = player_enum_to_symbol(playerTurn);
-    board->values[coords.row][coords.column][1] = marker;
+    set_symbol(coords, board, marker);
 }
 
 /**
@@ -291,23 +405,38 @@ bool check_full_load(char*** values, int height, int width) {
 }
 
 /**
- * Creates a copy of the main game board struct's values
+ * Creates a copy of the main game board struct's values (and empty counts)
  */
 Board copy_board(Board* board) {
 
     Board copiedBoard;
+    size_t numCells = (size_t) board->height * board->width;
 
     char*** values = allocate_board_memory(board->height, board->width);
-
-    for (int i = 0; i < board->height; i++) {
-        for (int j = 0; j < board->width; j++) {
-            strcpy(values[i][j], board->values[i][j]);
-        }
-    }
+    memcpy(values[0][0], board->values[0][0], sizeof(char) * 3 * numCells);
+    STAT_ADD(copyBoardCalls, 1);
+    STAT_ADD(copyBoardBytes, (sizeof(char) * 3 + sizeof(char*)) * numCells
+            + sizeof(char**) * board->height
+            + sizeof(int) * (board->height + board->width));
 
     copiedBoard.values = values;
     copiedBoard.height = board->height;
     copiedBoard.width = board->width;
+    copiedBoard.emptyInRow = NULL;
+    copiedBoard.emptyInCol = NULL;
+    copiedBoard.emptyInterior = board->emptyInterior;
+    copiedBoard.journal = NULL; // copies are scratch boards, never recorded
+
+    if (board->emptyInRow != NULL) {
+        copiedBoard.emptyInRow = malloc(sizeof(int) * board->height);
+        check_allocated_memory(copiedBoard.emptyInRow);
+        memcpy(copiedBoard.emptyInRow, board->emptyInRow,
+                sizeof(int) * board->height);
+        copiedBoard.emptyInCol = malloc(sizeof(int) * board->width);
+        check_allocated_memory(copiedBoard.emptyInCol);
+        memcpy(copiedBoard.emptyInCol, board->emptyInCol,
+                sizeof(int) * board->width);
+    }
     
     return copiedBoard;
 }
@@ -321,6 +450,7 @@ int calculate_score(Board* board, PlayerTurn playerTurn) {
 
     int totalScore = 0;
     char symbol = player_enum_to_symbol(playerTurn);
+    STAT_ADD(calculateScoreCalls, 1);
 
     for (int i = 1; i < board->height - 1; i++) {
         for (int j = 1; j < board->width - 1; j++) {
@@ -332,3 +462,53 @@ int calculate_score(Board* board, PlayerTurn playerTurn) {
 
     return totalScore;
 }
+
+
+/**
+ * Hashes a position (FNV-1a over the dimensions, whose turn it is and
+ * every cell), so that positions can be looked up in tables
+ * @param board the main game board struct
+ * @param playerTurn the player whose turn it is
+ * @returns 64 bit hash of the position
+ */
+uint64_t hash_board(Board* board, PlayerTurn playerTurn) {
+
+    uint64_t hash = FNV_OFFSET;
+    int header[3] = {board->height, board->width, playerTurn};
+
+    for (int i = 0; i < 3; i++) {
+        hash = (hash ^ (uint64_t) header[i]) * FNV_PRIME;
+    }
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            char* cell = board->values[i][j];
+            hash = (hash ^ (unsigned char) cell[0]) * FNV_PRIME;
+            hash = (hash ^ (unsigned char) cell[1]) * FNV_PRIME;
+        }
+    }
+
+    return hash;
+}
+
+/**
+ * Writes a board out in the savefile format (the format get_values reads)
+ * @param file the file to write to
+ * @param board the board to be saved
+ * @param playerTurn the player whose turn it is next
+ */
+void write_savefile(FILE* file, Board* board, PlayerTurn playerTurn) {
+
+    // adding rows and cols to top of file
+    fprintf(file, "%d %d\n", board->height, board->width);
+
+    // adding player turn to file
+    fprintf(file, "%c\n", player_enum_to_symbol(playerTurn));
+
+    for (int i = 0; i < board->height; i++) {
+        for (int j = 0; j < board->width; j++) {
+            fputs(board->values[i][j], file);
+        }
+        fputs("\n", file);
+    }
+}
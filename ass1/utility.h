@@ -1,4 +1,6 @@
+#include <stdio.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "types.h"
 
 void check_allocated_memory(void* ptr);
@@ -14,9 +16,16 @@ Coordinates get_adjacent_vertical_cell
 Coordinates get_adjacent_horizontal_cell
         (Coordinates coords, Board* board, bool right);     
 void free_board_values(char*** values, int height, int width);
+void free_board(Board* board);
 int sum_empty_cells_in_row(int col, Board* board);
 int sum_empty_cells_in_col(int col, Board* board);
+void count_empty_cells(Board* board);
+void record_change(Journal* journal, Coordinates coords, char before,
+        char after);
+void set_symbol(Coordinates coords, Board* board, char symbol);
 void place_marker(PlayerTurn playerTurn, Coordinates coords, Board* board);
 bool check_full_load(char*** values, int height, int width);
 Board copy_board(Board* board);
-int calculate_score(Board* board, PlayerTurn playerTurn);
\ No newline at end of file
+int calculate_score(Board* board, PlayerTurn playerTurn);
+uint64_t hash_board(Board* board, PlayerTurn playerTurn);
+void write_savefile(FILE* file, Board* board, PlayerTurn playerTurn);
\ No newline at end of file
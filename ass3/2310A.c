@@ -3,9 +3,12 @@
 // private functions
 int move_logic(Game* game, Player* player);
 
+// built with -DPLUGIN, the dealer loads move_logic and calls it itself
+#ifndef PLUGIN
 int main(int argc, char** argv) {
     run(argc, argv, &move_logic);
 }
+#endif
 
 /**
  * Determines how this player will handle a 'YT' message
@@ -17,27 +20,27 @@ int main(int argc, char** argv) {
 int move_logic(Game* game, Player* player) {
     // The player has money, and there is a Do site in front of them, go 
     if (player->money > 0) {
-        for (int i = player->site + 1; i < game->path.size; i++) {
-            if (game->path.sites[i].type == DO_SITE) {
-                if (!is_valid_move(game, game->path.sites[i], *player)) {
-                    continue;
-                }
+        // no Do past the next barrier can be moved to, so stop there
+        int nextBar = find_next_barrier(game, player->site);
+        for (int i = find_next_site_type(game, DO_SITE, player->site);
+                i != -1 && i < nextBar;
+                i = find_next_site_type(game, DO_SITE, i)) {
+            if (is_valid_move(game, i, player)) {
                 return i;
             }
         }
     }
     // If the next site is Mo, then go there
-    if (game->path.sites[player->site + 1].type == MO_SITE) {
-        if (is_valid_move(game, game->path.sites[player->site + 1],
-                *player)) {
+    if (game->path.types[player->site + 1] == MO_SITE) {
+        if (is_valid_move(game, player->site + 1, player)) {
             return player->site + 1;        
         }
     }
     // Pick the closest V1, V2 or ::, then go there
     for (int i = player->site + 1; i < game->path.size; i++) {
-        SiteType type = game->path.sites[i].type;
+        SiteType type = game->path.types[i];
         if (type == V1_SITE || type == V2_SITE || type == BAR_SITE) {
-            if (!is_valid_move(game, game->path.sites[i], *player)) {
+            if (!is_valid_move(game, i, player)) {
                 continue;
             }
             return i;
@@ -4,9 +4,12 @@
 int move_logic(Game* game, Player* player);
 bool compare_cards(Game* game, Player* player);
 
+// built with -DPLUGIN, the dealer loads move_logic and calls it itself
+#ifndef PLUGIN
 int main(int argc, char** argv) {
     run(argc, argv, &move_logic);
 }
+#endif
 
 /**
  * Determines how this player will handle a 'YT' message
@@ -17,7 +20,7 @@ int main(int argc, char** argv) {
  */
 int move_logic(Game* game, Player* player) {
     // next site capacity && all players on later sites -> move down 1 site
-    if (!is_site_full(&game->path.sites[player->site + 1])) {
+    if (!is_site_full(game, player->site + 1)) {
         int ourSite = player->site;
         bool validMove = true;
         for (int i = 0; i < game->numPlayers; i++) {
@@ -33,34 +36,35 @@ int move_logic(Game* game, Player* player) {
             return player->site + 1; // + 1 for next site
         }        
     }
-    int nextBar = find_next_site_type(game, BAR_SITE, player->site);
+    int nextBar = find_next_barrier(game, player->site);
     // If odd amount of money, and Mo between next BAR, then go there.
     if (player->money % 2 == 1) { // checking for odd amount of money
-        for (int i = player->site; i < game->path.size - 1; i++) {
-            int nextMo = find_next_site_type(game, MO_SITE, i);
-            if ((nextMo < nextBar) && (nextMo > 0)
-                    && !is_site_full(&game->path.sites[nextMo])) {
+        // try each Mo before the barrier in turn, until one has room
+        for (int nextMo = find_next_site_type(game, MO_SITE, player->site);
+                nextMo != -1 && nextMo < nextBar;
+                nextMo = find_next_site_type(game, MO_SITE, nextMo)) {
+            if (!is_site_full(game, nextMo)) {
                 return nextMo;
-            }            
+            }
         }
     }
     // go to next Ri if Ri before BAR & we have most cards | all have 0 cards
     if (compare_cards(game, player)) {
         int nextRi = find_next_site_type(game, RI_SITE, player->site);
         if ((nextRi < nextBar) && (nextRi > 0)
-                && !is_site_full(&game->path.sites[nextRi])) {
+                && !is_site_full(game, nextRi)) {
             return nextRi;
         }
     }
     // If there is a V2 between us and the next barrier, then go there.
     int nextV2 = find_next_site_type(game, V2_SITE, player->site);
     if ((nextV2 < nextBar) && (nextV2 > 0)
-            && !is_site_full(&game->path.sites[nextV2])) {
+            && !is_site_full(game, nextV2)) {
         return nextV2;
     }
     // Move forward to the earliest site which has room.
     for (int i = player->site + 1; i < game->path.size; i++) {
-        if (!is_site_full(&game->path.sites[i])) {
+        if (!is_site_full(game, i)) {
             return i;
         }
     }
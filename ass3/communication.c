@@ -1,19 +1,346 @@
+#include <unistd.h>
+#include <errno.h>
+#include <limits.h>
 #include "communication.h"
 
+// private functions
+void restore_held(LineReader* reader);
+bool fill_line_reader(LineReader* reader);
+int format_message_int(char* buffer, int number);
+void append_to_outbox(Outbox* outbox, const char* text, size_t length);
+char* parse_hap_fields(char* text, int* params, bool batched);
+
+/**
+ * Initialises a line reader for a file descriptor. Everything read from fd
+ * after this must go through the reader, since it reads ahead.
+ * @param reader the line reader to initialise
+ * @param fd the file descriptor to read lines from
+ */
+void init_line_reader(LineReader* reader, int fd) {
+    reader->fd = fd;
+    reader->size = LINE_BUFFER_SIZE;
+    reader->buffer = malloc(sizeof(char) * reader->size);
+    reader->start = 0;
+    reader->end = 0;
+    reader->holding = false;
+    reader->eof = false;
+}
+
+/**
+ * Frees the memory used by a line reader (doesn't close its fd)
+ * @param reader the line reader
+ */
+void free_line_reader(LineReader* reader) {
+    free(reader->buffer);
+}
+
+/**
+ * Puts back the byte that the last line's null terminator was written over
+ * @param reader the line reader
+ */
+void restore_held(LineReader* reader) {
+    if (reader->holding) {
+        reader->buffer[reader->heldIndex] = reader->held;
+        reader->holding = false;
+    }
+}
+
+/**
+ * Reads the next block from the reader's fd into its buffer, first moving
+ * the data not handed out yet to the front (and growing the buffer if it
+ * is all unread data already). One byte is always kept free for a null
+ * terminator.
+ * @param reader the line reader
+ * @returns false if nothing more could be read (EOF, an error, or a
+ * non-blocking fd with nothing in it yet; eof is only set for the first two)
+ */
+bool fill_line_reader(LineReader* reader) {
+    if (reader->start > 0) {
+        memmove(reader->buffer, reader->buffer + reader->start,
+                reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->end + 1 >= reader->size) {
+        reader->size *= 2;
+        reader->buffer = realloc(reader->buffer, sizeof(char) * reader->size);
+    }
+    ssize_t numRead;
+    do {
+        numRead = read(reader->fd, reader->buffer + reader->end,
+                reader->size - reader->end - 1);
+    } while (numRead == -1 && errno == EINTR);
+    if (numRead == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return false; // a non-blocking fd with nothing to read yet
+    }
+    if (numRead <= 0) {
+        reader->eof = true; // errors are treated like EOF, as fgetc does
+        return false;
+    }
+    reader->end += numRead;
+    return true;
+}
+
+/**
+* Gets a line from a line reader. A line is terminated at either '\n' or EOF.
+* @param reader the line reader to retrieve the line from
+* @param eof sets this bool to true iff EOF was encountered when getting line
+* @returns the line (including the '\n' if there was one) as a null
+* terminated char*. It belongs to the reader and is only valid until the
+* reader is next used. If the reader's fd is non-blocking and a whole line
+* hasn't arrived yet, NULL is returned and nothing is used up.
+*/
+char* read_line(LineReader* reader, bool* eof) {
+    restore_held(reader);
+    size_t searched = reader->start; // no '\n' before here
+    char* newline;
+    while ((newline = memchr(reader->buffer + searched, '\n',
+            reader->end - searched)) == NULL) {
+        searched = reader->end - reader->start;
+        if (reader->eof || !fill_line_reader(reader)) {
+            break;
+        }
+        searched += reader->start;
+    }
+    if (newline == NULL && !reader->eof) {
+        return NULL; // the rest of the line hasn't been written yet
+    }
+    char* line = reader->buffer + reader->start;
+    reader->start = (newline == NULL) ? reader->end
+            : (size_t) (newline - reader->buffer) + 1;
+    reader->heldIndex = reader->start;
+    reader->held = reader->buffer[reader->start];
+    reader->holding = true;
+    reader->buffer[reader->start] = '\0';
+    *eof = (newline == NULL);
+    return line;
+}
+
+/**
+ * Gets the next character from a line reader, like fgetc does
+ * @param reader the line reader
+ * @returns the next character as an unsigned char cast to an int,
+ * EOF if there are no more, or WOULD_BLOCK if the reader's fd is
+ * non-blocking and has nothing in it yet
+ */
+int read_char(LineReader* reader) {
+    restore_held(reader);
+    if (reader->start == reader->end
+            && (reader->eof || !fill_line_reader(reader))) {
+        return reader->eof ? EOF : WOULD_BLOCK;
+    }
+    return (unsigned char) reader->buffer[reader->start++];
+}
+
+/**
+ * Initialises an outbox, which holds messages until a (usually
+ * non-blocking) fd can take them
+ * @param outbox the outbox to initialise
+ * @param fd the file descriptor to write messages to
+ */
+void init_outbox(Outbox* outbox, int fd) {
+    outbox->fd = fd;
+    outbox->capacity = OUTBOX_SIZE;
+    outbox->data = malloc(sizeof(char) * outbox->capacity);
+    outbox->length = 0;
+    outbox->borrowed = NULL;
+    outbox->borrowedLength = 0;
+    outbox->sent = 0;
+    outbox->broken = false;
+}
+
+/**
+ * Frees the memory used by an outbox (doesn't close its fd)
+ * @param outbox the outbox
+ */
+void free_outbox(Outbox* outbox) {
+    free(outbox->data);
+}
+
+/**
+ * Adds text to the end of an outbox, without writing anything yet
+ * @param outbox the outbox, which mustn't be broken
+ * @param text the text
+ * @param length the length of text
+ */
+void append_to_outbox(Outbox* outbox, const char* text, size_t length) {
+    size_t unsent = outbox->borrowedLength + outbox->length - outbox->sent;
+    if (unsent == 0) {
+        outbox->borrowedLength = outbox->length = outbox->sent = 0;
+    }
+    if (outbox->length + length > outbox->capacity) {
+        while (outbox->length + length > outbox->capacity) {
+            outbox->capacity *= 2;
+        }
+        outbox->data = realloc(outbox->data,
+                sizeof(char) * outbox->capacity);
+    }
+    memcpy(outbox->data + outbox->length, text, length);
+    outbox->length += length;
+}
+
+/**
+ * Adds a message to the end of an outbox and writes as much as the fd will
+ * take straight away.
+ * Note, this function adds the new line character to the message.
+ * @param outbox the outbox
+ * @param message the message (without new line)
+ */
+void queue_message(Outbox* outbox, char* message) {
+    if (outbox->broken) {
+        return;
+    }
+    append_to_outbox(outbox, message, strlen(message));
+    append_to_outbox(outbox, "\n", 1);
+    flush_outbox(outbox);
+}
+
+/**
+ * Adds the HAP messages a player hasn't been sent yet to an outbox, as one
+ * batch message ("HAPS" then the params of each HAP, separated by ';').
+ * It isn't written until the next message is queued.
+ * @param outbox the player's outbox
+ * @param log the HAP messages
+ * @param delivered how much of the log the player has been sent, updated
+ */
+void queue_hap_batch(Outbox* outbox, HapLog* log, size_t* delivered) {
+    size_t start = *delivered - log->base;
+    if (outbox->broken || start == log->length) {
+        *delivered = log->base + log->length; // nothing (more) to send
+        return;
+    }
+    append_to_outbox(outbox, "HAPS", 4);
+    // + 1 skips the ';' before the first HAP
+    append_to_outbox(outbox, log->text + start + 1, log->length - start - 1);
+    append_to_outbox(outbox, "\n", 1);
+    *delivered = log->base + log->length;
+}
+
+/**
+ * Initialises an empty HAP log
+ * @param log the log
+ */
+void init_hap_log(HapLog* log) {
+    log->capacity = OUTBOX_SIZE;
+    log->text = malloc(sizeof(char) * log->capacity);
+    log->length = 0;
+    log->base = 0;
+}
+
+/**
+ * Frees the memory used by a HAP log
+ * @param log the log
+ */
+void free_hap_log(HapLog* log) {
+    free(log->text);
+}
+
+/**
+ * Checks whether a HAP log has to grow to take another message
+ * @param log the log
+ * @returns true iff it's full
+ */
+bool hap_log_full(HapLog* log) {
+    return log->length + MAX_HAP_LEN > log->capacity;
+}
+
+/**
+ * Adds a HAP message to the end of a HAP log
+ * @param log the log
+ * @param params the NUM_HAP_PARAMS parameters of the message
+ */
+void log_hap(HapLog* log, int* params) {
+    if (hap_log_full(log)) {
+        log->capacity *= 2;
+        log->text = realloc(log->text, sizeof(char) * log->capacity);
+    }
+    char hap[MAX_HAP_LEN];
+    int length = format_hap_message(hap, params);
+    // + 3 skips the "HAP", which is replaced with a ';'
+    log->text[log->length] = ';';
+    memcpy(log->text + log->length + 1, hap + 3, length - 3);
+    log->length += length - 2;
+}
+
+/**
+ * Drops the front of a HAP log, once every player has been sent it
+ * @param log the log
+ * @param oldest the position (counting dropped text) up to which everyone
+ * has been sent the log
+ */
+void trim_hap_log(HapLog* log, size_t oldest) {
+    size_t drop = oldest - log->base;
+    memmove(log->text, log->text + drop, log->length - drop);
+    log->length -= drop;
+    log->base = oldest;
+}
+
+/**
+ * Adds a message which the caller keeps hold of to an empty outbox, so a
+ * large message sent to many fds isn't copied for each of them.
+ * message must stay unchanged until the outbox is no longer pending.
+ * Note, a new line is added after the message.
+ * @param outbox the outbox, which must have nothing pending
+ * @param message the message (without new line)
+ * @param length the length of message
+ */
+void queue_borrowed_message(Outbox* outbox, const char* message,
+        size_t length) {
+    outbox->borrowed = message;
+    outbox->borrowedLength = length;
+    outbox->length = outbox->sent = 0;
+    queue_message(outbox, ""); // the new line
+}
+
+/**
+ * Writes as much of what is in an outbox as its fd will take
+ * @param outbox the outbox
+ * @returns true iff nothing is left to write
+ */
+bool flush_outbox(Outbox* outbox) {
+    while (outbox_pending(outbox)) {
+        const char* data = outbox->borrowed + outbox->sent;
+        size_t length = outbox->borrowedLength - outbox->sent;
+        if (outbox->sent >= outbox->borrowedLength) {
+            data = outbox->data + (outbox->sent - outbox->borrowedLength);
+            length = outbox->borrowedLength + outbox->length - outbox->sent;
+        }
+        ssize_t numWritten = write(outbox->fd, data, length);
+        if (numWritten > 0) {
+            outbox->sent += numWritten;
+        } else if (numWritten == -1
+                && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return false;
+        } else if (numWritten == -1 && errno != EINTR) {
+            outbox->broken = true; // e.g. EPIPE; the reader has gone
+        }
+    }
+    return true;
+}
+
 /**
- * Gets a decoded message from the indicated stream
- * @param stream the stream to get the message from
+ * Checks whether an outbox has anything left to write
+ * @param outbox the outbox
+ * @returns true iff there is something to write and the fd still works
+ */
+bool outbox_pending(Outbox* outbox) {
+    return !outbox->broken
+            && outbox->sent < outbox->borrowedLength + outbox->length;
+}
+
+/**
+ * Gets a decoded message from the indicated line reader
+ * @param reader the line reader to get the message from
  * @param decode function pointer to the function to be used to
  * decode the message; decode function must take in char* and return Message
  * @returns decoded message from indicated stream
  */
-Message get_message(FILE* stream, Message (*decode)(char*)) {
+Message get_message(LineReader* reader, Message (*decode)(char*)) {
     Message decodedMessage;
     bool eof; // set to true if EOF encountered, false otherwise
-    char* message = get_line(stream, &eof);
+    char* message = read_line(reader, &eof);
     decodedMessage = decode(message);
     decodedMessage.eof = eof;
-    free(message);
     return decodedMessage;
 }
 
@@ -27,4 +354,216 @@ Message get_message(FILE* stream, Message (*decode)(char*)) {
 void send_message(FILE* stream, char* message) {
     fprintf(stream, "%s\n", message);
     fflush(stream);
-}
\ No newline at end of file
+}
+
+/**
+ * Converts the characters from start up to end into an int, accepting
+ * exactly what string_to_int does (leading white space and a sign are
+ * allowed, a leading 0 is not unless it's the only character)
+ * @param start the first character of the number
+ * @param end one past the last character of the number
+ * @param number set to the number
+ * @returns true iff the characters are a valid number
+ */
+bool parse_message_int(char* start, char* end, int* number) {
+    if (end - start > 1 && *start == '0') {
+        return false;
+    }
+    char* c = start;
+    while (c < end && isspace(*c)) {
+        c++;
+    }
+    bool negative = (c < end && *c == '-');
+    if (c < end && (*c == '-' || *c == '+')) {
+        c++;
+    }
+    if (c == end) {
+        return false; // no digits
+    }
+    // strtol saturates at the limits of a long; the result is then an int
+    unsigned long limit = negative ? (unsigned long) LONG_MAX + 1 : LONG_MAX;
+    unsigned long magnitude = 0;
+    for (; c < end; c++) {
+        if (!isdigit(*c)) {
+            return false;
+        }
+        unsigned long digit = *c - '0';
+        magnitude = (magnitude > (limit - digit) / 10) ? limit
+                : magnitude * 10 + digit;
+    }
+    *number = (int) (negative ? -(long) (magnitude - 1) - 1 : (long) magnitude);
+    return true;
+}
+
+/**
+ * Parses the parameters of a HAP message in one pass
+ * @param text the message after the "HAP"; it may end with a '\n'
+ * @param params filled with the NUM_HAP_PARAMS parameters (the last one is
+ * the card character)
+ * @returns true iff there were exactly NUM_HAP_PARAMS comma separated
+ * parameters, all valid
+ */
+bool parse_hap_params(char* text, int* params) {
+    return parse_hap_fields(text, params, false) != NULL;
+}
+
+/**
+ * Parses the parameters of the next HAP message in a batch
+ * @param text the batch, after the "HAPS" or the last message's ';'
+ * @param params filled as for parse_hap_params
+ * @returns where the message ends (its ';', or the end of the batch), or
+ * NULL if it wasn't valid
+ */
+char* parse_hap_batch_entry(char* text, int* params) {
+    return parse_hap_fields(text, params, true);
+}
+
+/**
+ * Parses the parameters of a HAP message in one pass
+ * @param text the parameters, which may end with a '\n'
+ * @param params filled as for parse_hap_params
+ * @param batched true iff a ';' also ends the parameters
+ * @returns the character which ended the parameters, or NULL if they
+ * weren't valid
+ */
+char* parse_hap_fields(char* text, int* params, bool batched) {
+    char* start = text; // start of the current parameter
+    int numParams = 0;
+    for (char* c = text; ; c++) {
+        if (*c != ',' && *c != '\n' && *c != '\0'
+                && (*c != ';' || !batched)) {
+            continue;
+        }
+        if (c == start || numParams == NUM_HAP_PARAMS) {
+            return NULL; // empty or extra parameter
+        }
+        if (numParams < NUM_HAP_PARAMS - 1) {
+            if (!parse_message_int(start, c, &params[numParams])) {
+                return NULL;
+            }
+        } else if (c - start != 1 || !is_valid_card(*start)) {
+            return NULL;
+        } else {
+            params[numParams] = *start;
+        }
+        numParams++;
+        if (*c != ',') {
+            return (numParams == NUM_HAP_PARAMS) ? c : NULL;
+        }
+        start = c + 1;
+    }
+}
+
+/**
+ * Parses the parameter of a DO message
+ * @param text the message after the "DO"; it may end with a '\n'
+ * @param params set to the site in the message
+ * @returns true iff the site is a valid number
+ */
+bool parse_do_params(char* text, int* params) {
+    char* end = text;
+    while (*end != '\n' && *end != '\0') {
+        end++;
+    }
+    return parse_message_int(text, end, &params[0]);
+}
+
+/**
+ * Writes an int as decimal digits
+ * @param buffer where to write the digits (not null terminated)
+ * @param number the number to write
+ * @returns the number of characters written
+ */
+int format_message_int(char* buffer, int number) {
+    char digits[12]; // enough for any int, written backwards
+    unsigned int magnitude = (number < 0) ? -(unsigned int) number : number;
+    int numDigits = 0;
+    do {
+        digits[numDigits++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+    int length = 0;
+    if (number < 0) {
+        buffer[length++] = '-';
+    }
+    while (numDigits > 0) {
+        buffer[length++] = digits[--numDigits];
+    }
+    return length;
+}
+
+/**
+ * Writes a HAP message (without a new line) into a buffer
+ * @param buffer where to write the message, at least MAX_HAP_LEN long
+ * @param params the NUM_HAP_PARAMS parameters of the message
+ * @returns the length of the message
+ */
+int format_hap_message(char* buffer, int* params) {
+    int length = 0;
+    memcpy(buffer, "HAP", 3);
+    length += 3;
+    for (int i = 0; i < NUM_HAP_PARAMS - 1; i++) {
+        length += format_message_int(buffer + length, params[i]);
+        buffer[length++] = ',';
+    }
+    buffer[length++] = params[NUM_HAP_PARAMS - 1]; // the card
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * Writes a DO message (without a new line) into a buffer
+ * @param buffer where to write the message, at least MAX_DO_LEN long
+ * @param site the site to move to
+ * @returns the length of the message
+ */
+int format_do_message(char* buffer, int site) {
+    int length = 0;
+    memcpy(buffer, "DO", 2);
+    length += 2;
+    length += format_message_int(buffer + length, site);
+    buffer[length] = '\0';
+    return length;
+}
+
+/**
+ * Creates a message with no params (YT, EARLY or DONE)
+ * @param type the type of message
+ * @returns the message
+ */
+Message create_message(MessageType type) {
+    Message message;
+    message.messageType = type;
+    message.numParams = 0;
+    message.eof = false;
+    message.error = false;
+    return message;
+}
+
+/**
+ * Writes any message from the dealer (without a new line) into a buffer
+ * @param buffer where to write the message, at least MAX_HAP_LEN long
+ * @param message the message
+ * @returns the length of the message
+ */
+int format_message(char* buffer, Message* message) {
+    switch (message->messageType) {
+        case HAP:
+            return format_hap_message(buffer, message->params);
+        case DO:
+            return format_do_message(buffer, message->params[0]);
+        case YT:
+            strcpy(buffer, "YT");
+            break;
+        case EARLY:
+            strcpy(buffer, "EARLY");
+            break;
+        case DONE:
+            strcpy(buffer, "DONE");
+            break;
+        case HAPS:
+            buffer[0] = '\0'; // batches are sent from a HapLog
+            break;
+    }
+    return strlen(buffer);
+}
@@ -11,7 +11,62 @@
 #include "utility.h"
 #include "constants.h"
 
-Message get_message(FILE* stream, Message (*decode)(char*));
+typedef struct {
+    int fd; // the file descriptor lines are read from
+    char* buffer; // data read from fd that hasn't been handed out yet
+    size_t size; // the number of bytes allocated for buffer
+    size_t start; // index in buffer of the first byte not handed out
+    size_t end; // index in buffer one past the last byte read
+    size_t heldIndex; // where the last line's null terminator was written
+    char held; // the byte the null terminator replaced
+    bool holding; // true iff held needs to be put back before reading on
+    bool eof; // true once EOF (or a read error) has been hit on fd
+} LineReader;
+
+typedef struct {
+    int fd; // the file descriptor messages are written to
+    char* data; // messages waiting to be written
+    size_t length; // the number of bytes in data
+    size_t capacity; // the number of bytes allocated for data
+    const char* borrowed; // a message owned by the caller, sent before data
+    size_t borrowedLength; // the length of borrowed
+    size_t sent; // how much of borrowed and then data has been written
+    bool broken; // true once the fd can't be written to; messages are dropped
+} Outbox;
+
+typedef struct {
+    char* text; // HAP params, each after a ';', not sent to every player
+    size_t length; // the number of bytes in text
+    size_t capacity; // the number of bytes allocated for text
+    size_t base; // the number of bytes dropped from the front of text
+} HapLog;
+
+void init_line_reader(LineReader* reader, int fd);
+void free_line_reader(LineReader* reader);
+char* read_line(LineReader* reader, bool* eof);
+int read_char(LineReader* reader);
+void init_outbox(Outbox* outbox, int fd);
+void free_outbox(Outbox* outbox);
+void queue_message(Outbox* outbox, char* message);
+void queue_borrowed_message(Outbox* outbox, const char* message,
+        size_t length);
+bool flush_outbox(Outbox* outbox);
+bool outbox_pending(Outbox* outbox);
+void queue_hap_batch(Outbox* outbox, HapLog* log, size_t* delivered);
+void init_hap_log(HapLog* log);
+void free_hap_log(HapLog* log);
+bool hap_log_full(HapLog* log);
+void log_hap(HapLog* log, int* params);
+void trim_hap_log(HapLog* log, size_t oldest);
+Message get_message(LineReader* reader, Message (*decode)(char*));
+bool parse_message_int(char* start, char* end, int* number);
+bool parse_hap_params(char* text, int* params);
+char* parse_hap_batch_entry(char* text, int* params);
+bool parse_do_params(char* text, int* params);
+int format_hap_message(char* buffer, int* params);
+int format_do_message(char* buffer, int site);
+Message create_message(MessageType type);
+int format_message(char* buffer, Message* message);
 void send_message(FILE* stream, char* message);
 
 #endif
\ No newline at end of file
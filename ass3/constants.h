@@ -4,9 +4,25 @@
 #define NUM_HAP_PARAMS 5 // the number of parameters in a HAP message
 #define NUM_TYPE_CARD 5 // the number of types of cards there are
 #define CHARS_PER_SITE 3 // the number of characters per site 
+#define NUM_SITE_TYPES 6 // the number of types of sites there are
+// the two characters naming a site, as one number to switch on
+#define SITE_KEY(first, second) \
+        (((unsigned char) (first) << 8) | (unsigned char) (second))
 #define READ_END 0 // read end of pipe
 #define WRITE_END 1 // write end of pipe
 #define NUM_NON_PLAYER_ARGS 3 // the num of args which arent players
-#define MAX_HAP_LEN 50 // the max length of a hap message
+#define MAX_HAP_LEN 64 // the max length of a hap message
+#define MAX_DO_LEN 16 // the max length of a DO message
+#define LINE_BUFFER_SIZE 4096 // the initial size of a line reader's buffer
+#define OUTBOX_SIZE 256 // the initial size of an outbox's buffer
+#define WOULD_BLOCK -2 // read_char's result when a non-blocking fd is empty
+#define MAX_FEATURES 8 // the most protocol features that can be offered
+#define FEATURE_SHARED_MEMORY 'S' // messages go through a shared region
+#define FEATURE_BATCHED_HAPS 'B' // HAPs are held until the player's YT
+#define FEATURE_REUSABLE 'R' // players are sent "NEW" after DONE
+#define OFFER_VARIABLE "PLAYER_OFFER" // the features offered to a player
+#define SHARED_MEMORY_VARIABLE "PLAYER_SHARED_MEMORY" // the region's fds
+#define SHARED_RING_SIZE 1024 // the number of HAP messages the ring holds
+#define SHARED_POLL_MS 100 // how often players waiting check on the dealer
 
 #endif
\ No newline at end of file
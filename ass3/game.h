@@ -8,6 +8,10 @@ typedef struct {
     int numPlayers; // the number of players in game
     Path path; // the path in this game
     Player* players; // the players in this game
+    PlayerCoord* coords; // where each player is on the path, by id
+    int rearSite; // the first site with anyone on it
+    int* levelSites; // levelSites[i] is how many sites have over i players
+    int numLevels; // the most players on any site, i.e. rows of the path
 } Game;
 
 #endif
\ No newline at end of file
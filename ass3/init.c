@@ -1,76 +1,150 @@
 #include "init.h"
 
 // private functions
-Path init_path(FILE* pathStream, int numPlayers, bool dealer);
-int get_path_size(char* pathString, int colonIndex, Err err);
+Path init_path(char* pathString, int numPlayers, bool dealer);
+int get_path_size(char* pathString, char* colon, Err err);
 int get_size(FILE* pathFile, Err error);
-Site* get_path_sites(char* pathString, int size, int numPlayers, Err err);
+size_t path_block_size(int size, int numSlots);
+void lay_out_path(Path* path, int* block);
+void get_path_sites(char* pathString, Path* path, int numPlayers, Err err);
 Player* init_players(int numPlayers);
-Site string_to_site(char* site, Err err, int numPlayers);
-void place_initial_players(Path* path, int numPlayers);
+int decode_site_type(char first, char second);
+void string_to_site(char* site, Err err, int numPlayers, Path* path,
+        int index);
+void init_next_sites(Path* path);
+void place_initial_players(Game* game);
 
 /**
  * Initialises the game
- * @param pathStream the stream where the path is going to come in from
+ * @param pathString the path, as read by init_path_string
  * @param numPlayers the number of players in the game
  * @param dealer true iff the dealer is calling the function, false for players
  * @returns initialised Game struct
  */
-Game init_game(FILE* pathStream, int numPlayers, bool dealer) {
+Game init_game(char* pathString, int numPlayers, bool dealer) {
     Game game;
     game.numPlayers = numPlayers;
-    game.path = init_path(pathStream, numPlayers, dealer);
+    game.path = init_path(pathString, numPlayers, dealer);
     game.players = init_players(numPlayers);
+    game.coords = malloc(sizeof(PlayerCoord) * numPlayers);
+    game.levelSites = malloc(sizeof(int) * numPlayers);
+    place_initial_players(&game);
     return game;
 }
 
 /**
- * Reads in the path from pathStream and returns Path struct representing
- * that inputted path
- * @param pathStream the stream the path is coming in from
+ * Puts a game back the way init_game left it, so the same path can be
+ * played again without decoding it again
+ * @param game the game
+ */
+void reset_game(Game* game) {
+    for (int i = 0; i < game->path.size; i++) {
+        game->path.occupancy[i] = 0;
+    }
+    for (int i = 0; i < game->numPlayers; i++) {
+        game->players[i] = init_player(i);
+    }
+    place_initial_players(game);
+}
+
+/**
+ * Decodes the string version of a path into a Path struct
+ * @param pathString the path (without a trailing new line)
  * @param numPlayers the number of players in this game
  * @param dealer true if dealer is calling, false if player is called 
  * (This is done so correct error is thrown depending on who calls function)
- * @returns Path struct representing string version of path in pathStream 
+ * @returns Path struct representing pathString
  */
-Path init_path(FILE* pathStream, int numPlayers, bool dealer) {
+Path init_path(char* pathString, int numPlayers, bool dealer) {
     Path path;
     Err err = dealer ? BAD_DEALER_PATH : BAD_PLAYER_PATH;
-    char* pathString = init_path_string(pathStream);
-    // ensuring no trailing characters when dealer reading path from file
-    if (dealer && fgetc(pathStream) != EOF) {
-        err_msg(BAD_DEALER_PATH);
-    }
-    int colonIndex = -1; // the index in the path string where the ; is
-    for (int i = 0; i < strlen(pathString); i++) {
-        if (pathString[i] == ';') {
-            colonIndex = i;
-        }
+    char* colon = strrchr(pathString, ';'); // the size ends at the last ;
+    if (colon == NULL) {
+        err_msg(err);
     }
-    if (colonIndex == -1) { // if -1, a colon wasn't found in pathString
+    path.size = get_path_size(pathString, colon, err);   
+    // every site is CHARS_PER_SITE long, so the size can be checked before
+    // anything is allocated for it
+    if (strlen(colon + 1) != (size_t) path.size * CHARS_PER_SITE) {
         err_msg(err);
     }
-    path.size = get_path_size(pathString, colonIndex, err);   
-    path.sites = get_path_sites(pathString + colonIndex + 1,
-            path.size, numPlayers, err);
-    place_initial_players(&path, numPlayers);
-    free(pathString);
+    // the sites' types and capacities first, then room for their players
+    lay_out_path(&path, malloc(path_block_size(path.size, 0)));
+    get_path_sites(colon + 1, &path, numPlayers, err);
+    int numSlots = 0;
+    for (int i = 0; i < path.size; i++) {
+        path.firstSlot[i] = numSlots;
+        path.occupancy[i] = 0;
+        numSlots += path.capacities[i];
+    }
+    path.firstSlot[path.size] = numSlots;
+    lay_out_path(&path, realloc(path.types,
+            path_block_size(path.size, numSlots)));
+    init_next_sites(&path);
     return path;
 }
 
+/**
+ * Works out how big the one allocation holding a path's arrays must be
+ * @param size the number of sites in the path
+ * @param numSlots the total capacity of the sites
+ * @returns the size of the block in bytes
+ */
+size_t path_block_size(int size, int numSlots) {
+    // types, capacities, occupancy, firstSlot, the nextSite tables, then
+    // the player slots; everything is an int
+    return sizeof(int) * ((size_t) size * 3 + (size + 1)
+            + (size_t) NUM_SITE_TYPES * (size + 1) + numSlots);
+}
+
+/**
+ * Points a path's arrays into the block holding them. The arrays keep
+ * their place in the block however big it is, so the block can be grown.
+ * @param path pointer to the path, with its size set
+ * @param block the block, at least path_block_size bytes
+ */
+void lay_out_path(Path* path, int* block) {
+    int size = path->size;
+    path->types = (SiteType*) block;
+    path->capacities = block + size;
+    path->occupancy = block + size * 2;
+    path->firstSlot = block + size * 3;
+    int* tables = path->firstSlot + size + 1;
+    for (int type = 0; type < NUM_SITE_TYPES; type++) {
+        path->nextSite[type] = tables + type * (size + 1);
+    }
+    path->playerIds = tables + NUM_SITE_TYPES * (size + 1);
+}
+
+/**
+ * Builds the tables of where the next site of each type is, so the path
+ * never has to be walked to find one
+ * @param path pointer to the path, with its sites decoded
+ */
+void init_next_sites(Path* path) {
+    for (int type = 0; type < NUM_SITE_TYPES; type++) {
+        path->nextSite[type][path->size] = -1; // nothing after the end
+    }
+    for (int i = path->size - 1; i >= 0; i--) {
+        for (int type = 0; type < NUM_SITE_TYPES; type++) {
+            path->nextSite[type][i] = path->nextSite[type][i + 1];
+        }
+        path->nextSite[path->types[i]][i] = i;
+    }
+}
+
 /**
  * Extracts the size of the path from the path string
  * @param pathString the string format of path
- * @param colonIndex the index of the semicolon in the path string
+ * @param colon pointer to the semicolon ending the size in the path string
  * @param err the type of com error to be thrown
  * @returns the size of the path (i.e. how many sites on path)
  */
-int get_path_size(char* pathString, int colonIndex, Err err) {
-    char sizeString[colonIndex + 1]; // +1 for null terminator
-    strncpy(sizeString, pathString, colonIndex);
-    sizeString[colonIndex] = '\0';
+int get_path_size(char* pathString, char* colon, Err err) {
     int error;
-    int size = string_to_int(sizeString, &error);
+    *colon = '\0'; // the size is read in place, then the ; put back
+    int size = string_to_int(pathString, &error);
+    *colon = ';';
     if (error || size < 2) {
         err_msg(err);
     }
@@ -78,45 +152,81 @@ int get_path_size(char* pathString, int colonIndex, Err err) {
 }
 
 /**
- * Extracts the sites from a pathstring
+ * Extracts the types and capacities of the sites from a pathstring
  * @param pathString the pathstring not including the size and ';' at start
- * @param size the number of sites in the path
+ * @param path pointer to the path, laid out for its size
  * @param numPlayers the number of players in the game
  * @param err the type of com error to be thrown
- * @returns "array" of sites with all the sites on the path
  */
-Site* get_path_sites(char* pathString, int size, int numPlayers, Err err) {
-    Site* sites = malloc(sizeof(Site) * size);
-    char* siteBuffer = calloc(sizeof(char), CHARS_PER_SITE + 1); 
+void get_path_sites(char* pathString, Path* path, int numPlayers, Err err) {
+    int size = path->size;
+    // the length was checked, so each site is there to be decoded in place
     for (int i = 0; i < size; i++) {
-        strncpy(siteBuffer, pathString, CHARS_PER_SITE);
-        siteBuffer[CHARS_PER_SITE] = '\0';
+        string_to_site(pathString, err, numPlayers, path, i);
         pathString += CHARS_PER_SITE;
-        sites[i] = string_to_site(siteBuffer, err, numPlayers);
-        sites[i].siteNumber = i;
-    }
-    if (strlen(pathString) != 0) {
-        err_msg(err); // there should not be any content after
     }
     // there should be barrier site at the start and end of path
-    if (sites[0].type != BAR_SITE || sites[size - 1].type != BAR_SITE) {
+    if (path->types[0] != BAR_SITE || path->types[size - 1] != BAR_SITE) {
         err_msg(err);
     }    
-    free(siteBuffer);
-    return sites;
 }
 
 /**
- * Gets the path from a file and returns it as a null terminated char*
- * @param stream the stream the path file is coming from
- * @returns null terminated char* representing path
+ * Reads a path file, which must be a single line, in as few reads as
+ * possible. The buffer read into becomes the path string, so the file
+ * isn't copied or read again.
+ * @param pathFile the name of the path file
+ * @returns null terminated char* representing path, which must be freed
  */
-char* init_path_string(FILE* stream) {
+char* read_path_file(char* pathFile) {
+    int fd = open(pathFile, O_RDONLY);
+    if (fd == -1) {
+        err_msg(BAD_DEALER_PATH); // couldn't open path file
+    }
+    struct stat info;
+    // + 1 so a regular file is read to EOF without growing the buffer
+    size_t capacity = (fstat(fd, &info) == 0 && info.st_size > 0)
+            ? (size_t) info.st_size + 1 : LINE_BUFFER_SIZE;
+    char* pathString = malloc(sizeof(char) * capacity);
+    size_t length = 0;
+    ssize_t got;
+    while ((got = read(fd, pathString + length, capacity - length)) != 0) {
+        if (got == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            err_msg(BAD_DEALER_PATH);
+        }
+        length += got;
+        if (length == capacity) {
+            capacity *= 2;
+            pathString = realloc(pathString, sizeof(char) * capacity);
+        }
+    }
+    close(fd);
+    // the only new line must be the one ending the file
+    char* newline = memchr(pathString, '\n', length);
+    if (newline == NULL || newline != pathString + length - 1) {
+        err_msg(BAD_DEALER_PATH);
+    }
+    *newline = '\0';
+    return pathString;
+}
+
+/**
+ * Gets the path line from a line reader and returns it as a null
+ * terminated char*
+ * @param reader the line reader the path is coming from
+ * @returns null terminated char* representing path, which must be freed
+ */
+char* init_path_string(LineReader* reader) {
     bool eof;
-    char* pathString = get_line(stream, &eof);
+    char* line = read_line(reader, &eof);
     if (eof) {
         err_msg(BAD_DEALER_PATH);
     }
+    char* pathString = malloc(sizeof(char) * (strlen(line) + 1));
+    strcpy(pathString, line);
     strtok(pathString, "\n"); // remove trailing new line
     return pathString;
 }
@@ -175,7 +285,9 @@ Player init_player(int id) {
     Player player;
     player.playerId = id;
     player.site = 0; // players start at site 0
-    player.cards = calloc(NUM_TYPE_CARD, sizeof(int));
+    for (int i = 0; i < NUM_TYPE_CARD; i++) {
+        player.cards[i] = 0;
+    }
     player.money = 7; // players start with 7 money
     player.points = 0;
     player.v1 = 0;
@@ -184,57 +296,73 @@ Player init_player(int id) {
 }
 
 /**
- * Converts the char* representation of a site (e.g. V11 OR ::-) to decoded
- * site struct
- * @param site the char* representation of a site
+ * Works out which type of site its first two characters name
+ * @param first the first character of the site
+ * @param second the second character of the site
+ * @returns the SiteType, or -1 if the characters don't name one
+ */
+int decode_site_type(char first, char second) {
+    switch (SITE_KEY(first, second)) {
+        case SITE_KEY('M', 'o'):
+            return MO_SITE;
+        case SITE_KEY('V', '1'):
+            return V1_SITE;
+        case SITE_KEY('V', '2'):
+            return V2_SITE;
+        case SITE_KEY('D', 'o'):
+            return DO_SITE;
+        case SITE_KEY('R', 'i'):
+            return RI_SITE;
+        case SITE_KEY(':', ':'):
+            return BAR_SITE;
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Decodes the char* representation of a site (e.g. V11 OR ::-) into the
+ * path's type and capacity for it
+ * @param site the CHARS_PER_SITE characters representing a site
  * @param err the error to be thrown in case of a bad path
  * (Because both player and dealer call this function.)
  * @param numPlayers the number of players in the game
- * @returns Site struct type rep of inputted string rep of a site 
- */
-Site string_to_site(char* site, Err err, int numPlayers) {
-    Site decodedSite; // struct form of site
-    decodedSite.numPlayers = 0;
-    decodedSite.capacity = (site[2] - '0');
-    site[2] = '\0'; // only care about site chars now
-    if (strcmp(site, "Mo") == 0) {
-        decodedSite.type = MO_SITE;
-    } else if (strcmp(site, "V1") == 0) {
-        decodedSite.type = V1_SITE;
-    } else if (strcmp(site, "V2") == 0) {
-        decodedSite.type = V2_SITE;
-    } else if (strcmp(site, "Do") == 0) {
-        decodedSite.type = DO_SITE;
-    } else if (strcmp(site, "Ri") == 0) {
-        decodedSite.type = RI_SITE;
-    } else if (strcmp(site, "::") == 0) {
-        decodedSite.type = BAR_SITE;
-    } else {
+ * @param path pointer to the path the site is on
+ * @param index where the site is on the path
+ */
+void string_to_site(char* site, Err err, int numPlayers, Path* path,
+        int index) {
+    int type = decode_site_type(site[0], site[1]);
+    int capacity = (site[2] - '0');
+    if (type == -1) {
         err_msg(err);
     }
-    if (decodedSite.type == BAR_SITE) {
-        if (decodedSite.capacity != -3) {
+    if (type == BAR_SITE) {
+        if (capacity != -3) {
             err_msg(err);
         }
-        decodedSite.capacity = numPlayers;
+        capacity = numPlayers;
     } else {
-        if (decodedSite.capacity < 1 || decodedSite.capacity > 9) {
+        if (capacity < 1 || capacity > 9) {
             err_msg(err);
         }
     }
-    decodedSite.playerIds = calloc(decodedSite.capacity, sizeof(int));
-    return decodedSite;       
+    path->types[index] = type;
+    path->capacities[index] = capacity;
 }
 
 /**
  * Places the player ids in the first site of the path in descending order
  * at the start of the game
- * @param path pointer to path struct for this game
- * @param numPlayers the number of players in this game
+ * @param game pointer to the game, with its path and players initialised
  */
-void place_initial_players(Path* path, int numPlayers) {
-    for (int i = numPlayers - 1; i >= 0; i--) {
-        path->sites[0].playerIds[numPlayers - 1 - i] = i;
-        path->sites[0].numPlayers++;
+void place_initial_players(Game* game) {
+    game->rearSite = 0;
+    game->numLevels = 0;
+    for (int i = 0; i < game->numPlayers; i++) {
+        game->levelSites[i] = 0;
+    }
+    for (int i = game->numPlayers - 1; i >= 0; i--) {
+        place_player(game, 0, &game->players[i]);
     }
 }
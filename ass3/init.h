@@ -4,15 +4,23 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "game.h"
 #include "errs.h"
+#include "logic.h"
 #include "utility.h"
 #include "deck.h"
+#include "communication.h"
 #include "constants.h"
 
-Game init_game(FILE* pathStream, int numPlayers, bool dealer);
+Game init_game(char* pathString, int numPlayers, bool dealer);
 Player init_player(int id);
+void reset_game(Game* game);
 Deck init_deck(FILE* deckStream);
-char* init_path_string(FILE* stream);
+char* read_path_file(char* pathFile);
+char* init_path_string(LineReader* reader);
 
 #endif
\ No newline at end of file
@@ -5,22 +5,19 @@
 #include "logic.h"
 
 //private functions
-void place_player(Site* site, Player* player);
 void remove_player(Game* game, Player* player);
-int find_next_barrier(Game* game, int startingSite);
-bool is_valid_move(Game* game, Site newSite, Player player);
 
 /**
  * Moves a player from the site they are currently on to a new site
  * @param game pointer to the main game struct
  * @param player pointer to the player to be moved
- * @param site pointer to the site the player should be moved to
+ * @param newSite the site the player should be moved to
  * @returns true if the player was sucessfully moved, false otherwise
  */
-bool move_player(Game* game, Player* player, Site* newSite) {
-    if (is_valid_move(game, *newSite, *player)) {
+bool move_player(Game* game, Player* player, int newSite) {
+    if (is_valid_move(game, newSite, player)) {
         remove_player(game, player);
-        place_player(newSite, player);
+        place_player(game, newSite, player);
         return true;
     }
     return false;
@@ -33,32 +30,57 @@ bool move_player(Game* game, Player* player, Site* newSite) {
  * @returns true iff player was successfully removed from it's site
  */
 void remove_player(Game* game, Player* player) {
-    Site* site = &game->path.sites[player->site];
-    int index = -1; // where the player is in the site
-    for (int i = 0; i < site->numPlayers; i++) {
-        if (site->playerIds[i] == player->playerId) {
-            index = i;
-        }
+    PlayerCoord* coord = &game->coords[player->playerId];
+    int* playerIds = site_players(&game->path, coord->site);
+    int* occupancy = &game->path.occupancy[coord->site];
+    // move everyone who arrived after the player back a slot
+    for (int i = coord->siteIndex; i < *occupancy - 1; i++) {
+        playerIds[i] = playerIds[i + 1];
+        game->coords[playerIds[i]].siteIndex = i;
     }
-    if (index != site->numPlayers - 1) {
-        // move everyone in front of player backwards
-        for (int i = index; i < site->numPlayers; i++) {
-            site->playerIds[index] = site->playerIds[index + 1];
-        }
+    (*occupancy)--;
+    // the levels only ever get emptied from the top down
+    if (--game->levelSites[*occupancy] == 0) {
+        game->numLevels = *occupancy;
+    }
+    // players only move forward, so the rear only ever moves forward too
+    while (game->rearSite < game->path.size - 1
+            && game->path.occupancy[game->rearSite] == 0) {
+        game->rearSite++;
     }
-    site->numPlayers--;
 }
 
 /**
- * Attempts to place player at Site. Returns true iff placement is valid.
+ * Places player at the back of site, which must have room
+ * @param game pointer to the main game struct
  * @param site the site for the player to be placed at
  * @param player the player to be placed
- * @returns true iff player was successfully placed at the new site
  */
-void place_player(Site* site, Player* player) {
-    site->playerIds[site->numPlayers] = player->playerId;
-    player->site = site->siteNumber;
-    site->numPlayers++;
+void place_player(Game* game, int site, Player* player) {
+    int* occupancy = &game->path.occupancy[site];
+    game->coords[player->playerId].site = site;
+    game->coords[player->playerId].siteIndex = *occupancy;
+    site_players(&game->path, site)[*occupancy] = player->playerId;
+    player->site = site;
+    game->levelSites[*occupancy]++;
+    (*occupancy)++;
+    if (*occupancy > game->numLevels) {
+        game->numLevels = *occupancy;
+    }
+    if (site < game->rearSite) {
+        game->rearSite = site;
+    }
+}
+
+/**
+ * Finds the players at a site, in the order they arrived
+ * @param path pointer to the path
+ * @param site the site
+ * @returns the site's slots in the path's playerIds; the first
+ * occupancy[site] of them are in use
+ */
+int* site_players(Path* path, int site) {
+    return path->playerIds + path->firstSlot[site];
 }
 
 /**
@@ -69,12 +91,11 @@ void place_player(Site* site, Player* player) {
  * @param player the player that wants to move
  * @returns true iff player moving to newSite is valid
  */
-bool is_valid_move(Game* game, Site newSite, Player player) {
-    if (is_site_full(&newSite)) {
+bool is_valid_move(Game* game, int newSite, Player* player) {
+    if (is_site_full(game, newSite)) {
         return false;
     }
-    if (newSite.siteNumber
-            > find_next_site_type(game, BAR_SITE, player.site)) {
+    if (newSite > find_next_barrier(game, player->site)) {
         return false;
     }
     return true;
@@ -82,11 +103,12 @@ bool is_valid_move(Game* game, Site newSite, Player player) {
 
 /**
  * Returns true if the site is full, false if there is room
- * @param site pointer to site to check if it's full
+ * @param game pointer to main game struct
+ * @param site the site to check if it's full
  * @returns true if the site is full, false if there is room
  */
-bool is_site_full(Site* site) {
-    return site->numPlayers >= site->capacity;
+bool is_site_full(Game* game, int site) {
+    return game->path.occupancy[site] >= game->path.capacities[site];
 }
 
 /**
@@ -96,51 +118,46 @@ bool is_site_full(Site* site) {
  * @returns the index of the next site with Type, -1 if one can't be found
  */
 int find_next_site_type(Game* game, SiteType type, int startingSite) {
-    for (int i = startingSite + 1; i < game->path.size; i++) {
-        if (game->path.sites[i].type == type) {
-            return i;
-        }        
+    if (startingSite < -1 || startingSite >= game->path.size) {
+        return -1;
     }
-    return -1;
+    return game->path.nextSite[type][startingSite + 1];
 }
 
 /**
- * Finds where a player is in the path
+ * Finds the next barrier after the startingSite index; no player can move
+ * past it
+ * @param startingSite the index from which to start the search from
+ * (not including that site)
+ * @returns the index of the next barrier, -1 if one can't be found
+ */
+int find_next_barrier(Game* game, int startingSite) {
+    return find_next_site_type(game, BAR_SITE, startingSite);
+}
+
+/**
+ * Finds a player in the game; players are kept in order of id
  * @param game pointer to main game struct
  * @param id the playerId for the player to be found
  * @param error the error to be thrown if player can't be found
  * @returns pointer to the player with specified id
  */
 Player* find_player(Game* game, int id, Err error) {
-    Player* p;
-    PlayerCoord pc;
-    pc.site = -1; // so returns invalid coord if player cant be found
-    pc.siteIndex = -1;
-    for (int i = 0; i < game->path.size; i++) {
-        for (int j = 0; j < game->path.sites[i].capacity; j++) {
-            if (game->path.sites[i].playerIds[j] == id) {
-                pc.site = i;
-                pc.siteIndex = j;
-                break;
-            }
-        }
+    if (id < 0 || id >= game->numPlayers) {
+        err_msg(error); // if player cant be found, an error has occured
     }
-    p = &game->players[game->path.sites[pc.site].playerIds[pc.siteIndex]];
-    if (pc.site != -1 && pc.siteIndex != -1) {
-        return p;
-    }
-    err_msg(error); // if player cant be found, an error has occured
-    return p; // needed so compiler doesn't throw warning
+    return &game->players[id];
 }
 
 /**
  * Updates Player after a HAP message
+ * @param game pointer to main game struct
  * @param player pointer to the player to be updated 
  * @param newSite the site the player has moved to
  * @param message pointer to HAP message with values to update player with
  */
-void update_player(Player* player, Site newSite, Message* message) {
-    player->site = newSite.siteNumber;
+void update_player(Game* game, Player* player, int newSite, Message* message) {
+    player->site = newSite;
     player->points += message->params[2];
     player->money += message->params[3];
     if (message->params[4] != '0') {
@@ -149,7 +166,7 @@ void update_player(Player* player, Site newSite, Message* message) {
         // Similar applies for other cards
         player->cards[message->params[4] - '0' - 1]++; 
     }
-    switch(newSite.type) {
+    switch(game->path.types[newSite]) {
         case V1_SITE:
             player->v1++;
             break;
@@ -9,12 +9,15 @@
 #include "utility.h"
 #include "constants.h"
 
-bool move_player(Game* game, Player* player, Site* newSite);
+bool move_player(Game* game, Player* player, int newSite);
+void place_player(Game* game, int site, Player* player);
+int* site_players(Path* path, int site);
 Player* find_player(Game* game, int id, Err error);
-void update_player(Player* player, Site newSite, Message* message);
-bool is_valid_move(Game* game, Site newSite, Player player);
-bool is_site_full(Site* site);
+void update_player(Game* game, Player* player, int newSite, Message* message);
+bool is_valid_move(Game* game, int newSite, Player* player);
+bool is_site_full(Game* game, int site);
 int find_next_site_type(Game* game, SiteType type, int startingSite);
+int find_next_barrier(Game* game, int startingSite);
 int sum_cards(Player* player);
 void distribute_extra_points(Game* game);
 
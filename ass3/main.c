@@ -1,20 +1,37 @@
 #include "main.h"
 
 Dealer init_dealer(char* deckFile, char* pathFile, int numPlayers);
+void init_features(Dealer* dealer);
+bool is_plugin(char* program);
+void load_plugins(Dealer* dealer);
 void setup_signal_handlers(void);
 void handle_signals(int s);
 void create_pipes(Dealer* dealer);
-void create_players(Dealer* dealer, char** playerPrograms);
+void create_player_pipes(Dealer* dealer, int id);
+void create_players(Dealer* dealer);
+void create_player(Dealer* dealer, int id);
+void restart_player(Dealer* dealer, int id);
 void redirect_child_fds(Dealer* dealer, int childNumber);
-void send_all_players_message(Dealer* dealer, char* message);
-void send_players_path(Dealer* dealer);
+void set_child_offer(Dealer* dealer);
+void send_all_players_message(Dealer* dealer, Message* message);
+void publish_shared_event(Dealer* dealer, Message* event);
+void log_batched_hap(Dealer* dealer, Message* hap);
+void send_hap_batch(Dealer* dealer, int id);
+void send_players_path(Dealer* dealer, bool* starting);
+void start_next_game(Dealer* dealer);
+bool accept_features(Dealer* dealer, int id, char* features);
+long long now_ms(void);
+long long turn_deadline(Dealer* dealer);
+bool poll_players(Dealer* dealer, long long deadline);
+bool flush_all_outboxes(Dealer* dealer, long long deadline);
+Message get_move(Dealer* dealer, int id);
+Message get_plugin_move(Dealer* dealer, int id);
 void play(Dealer* dealer);
 bool turn(Dealer* dealer);
-void update(Dealer* dealer, Player* player, Site* newSite, int* hapParams);
+void update(Dealer* dealer, Player* player, int newSite, Message* hap);
 int find_farthest_back(Dealer* dealer);
 Message decode_player_message(char* message);
-int* create_hap_params(Dealer* dealer, Player* player, Site* newSite);
-char* create_hap_message(int* hapParams);
+Message create_hap(Dealer* dealer, Player* player, int newSite);
 void kill_all_children(Dealer* dealer);
 void early_game_over(Dealer* dealer);
 void free_dealer(Dealer* dealer);
@@ -26,15 +43,32 @@ int main(int argc, char** argv) {
         err_msg(BAD_DEALER_ARGS);
     }
     Dealer dealer = init_dealer(argv[1], argv[2], argc - NUM_NON_PLAYER_ARGS);
+    dealer.playerPrograms = argv + NUM_NON_PLAYER_ARGS;
     globalDealer = &dealer;
     setup_signal_handlers();
+    load_plugins(&dealer);
     create_pipes(&dealer);
-    create_players(&dealer, argv + NUM_NON_PLAYER_ARGS);
-    send_players_path(&dealer);
+    create_players(&dealer);
+    bool* starting = malloc(sizeof(bool) * dealer.game.numPlayers);
+    for (int i = 0; i < dealer.game.numPlayers; i++) {
+        starting[i] = (dealer.moveLogics[i] == NULL);
+    }
+    send_players_path(&dealer, starting);
+    free(starting);
     dealer.gameStarted = true;
-    play(&dealer);
-    send_all_players_message(&dealer, "DONE");
+    for (int i = 0; i < dealer.numGames; i++) {
+        if (i > 0) {
+            start_next_game(&dealer);
+        }
+        play(&dealer);
+        Message done = create_message(DONE);
+        send_all_players_message(&dealer, &done);
+    }
+    flush_all_outboxes(&dealer, turn_deadline(&dealer));
     kill_all_children(&dealer);
+    // the dealer is about to go out of scope, but the children being
+    // killed can still cause signals
+    globalDealer = NULL;
     free_dealer(&dealer);
     return 0;
 }
@@ -56,14 +90,9 @@ Dealer init_dealer(char* deckFile, char* pathFile, int numPlayers) {
     Deck deck = init_deck(deckStream);
     fclose(deckStream);
     // loading path
-    FILE* pathStream = fopen(pathFile, "r");
-    if (pathStream == NULL) {
-        err_msg(BAD_DEALER_PATH); // couldn't open path file
-    }
-    Game game = init_game(pathStream, numPlayers, true);
-    rewind(pathStream); // go back to the start of the stream
-    char* pathString = init_path_string(pathStream);
-    fclose(pathStream);
+    char* pathString = read_path_file(pathFile);
+    Game game = init_game(pathString, numPlayers, true);
+    dealer.output = choose_output_mode(stdout, OUTPUT_VARIABLE);
     // dynamically allocating memory from streams/pipes
     dealer.dealerToPlayer = malloc(sizeof(int*) * numPlayers);
     dealer.playerToDealer = malloc(sizeof(int*) * numPlayers);
@@ -71,16 +100,115 @@ Dealer init_dealer(char* deckFile, char* pathFile, int numPlayers) {
         dealer.dealerToPlayer[i] = malloc(sizeof(int) * 2); // 2 fds per pipe
         dealer.playerToDealer[i] = malloc(sizeof(int) * 2);
     }
-    dealer.dealerToPlayerStreams = malloc(sizeof(FILE*) * numPlayers);
-    dealer.playerToDealerStreams = malloc(sizeof(FILE*) * numPlayers);
+    dealer.outboxes = malloc(sizeof(Outbox) * numPlayers);
+    dealer.playerToDealerReaders = malloc(sizeof(LineReader) * numPlayers);
+    dealer.awaiting = calloc(numPlayers, sizeof(bool));
+    dealer.inputReady = calloc(numPlayers, sizeof(bool));
+    dealer.pollFds = malloc(sizeof(struct pollfd) * (numPlayers * 2 + 1));
+    dealer.batching = calloc(numPlayers, sizeof(bool));
+    dealer.numBatching = 0;
+    init_hap_log(&dealer.hapLog);
+    dealer.delivered = calloc(numPlayers, sizeof(size_t));
+    char* timeout = getenv(TURN_TIMEOUT_VARIABLE);
+    int error = 1;
+    dealer.turnTimeout = (timeout == NULL) ? -1
+            : string_to_int(timeout, &error);
+    if (error || dealer.turnTimeout < 0) {
+        dealer.turnTimeout = -1; // no limit
+    }
+    char* games = getenv(GAMES_VARIABLE);
+    error = 1;
+    dealer.numGames = (games == NULL) ? 1 : string_to_int(games, &error);
+    if (error || dealer.numGames < 1) {
+        dealer.numGames = 1;
+    }
+    dealer.reusable = calloc(numPlayers, sizeof(bool));
+    // "NEW" + the path + the null terminator
+    dealer.newGameMessage = malloc(sizeof(char) * (strlen(pathString) + 4));
+    sprintf(dealer.newGameMessage, "NEW%s", pathString);
     dealer.game = game;
     dealer.deck = deck;
     dealer.pathString = pathString;
     dealer.playerPids = malloc(sizeof(pid_t) * numPlayers);
     dealer.gameStarted = false;
+    init_features(&dealer);
     return dealer;
 }
 
+/**
+ * Works out which protocol features players are offered: those asked for
+ * in FEATURES_VARIABLE which this dealer supports (and can set up)
+ * @param dealer pointer to main dealer struct
+ */
+void init_features(Dealer* dealer) {
+    char* wanted = getenv(FEATURES_VARIABLE);
+    int numOffered = 0;
+    dealer->shared = NULL;
+    dealer->sharedDescription = NULL;
+    for (char* c = SUPPORTED_FEATURES; *c != '\0'; c++) {
+        if (wanted == NULL || strchr(wanted, *c) == NULL) {
+            continue;
+        }
+        if (*c == FEATURE_SHARED_MEMORY) {
+            dealer->shared = create_shared_link(dealer->game.numPlayers);
+            if (dealer->shared == NULL) {
+                continue; // players just use their pipes
+            }
+            dealer->sharedDescription = describe_shared_link(dealer->shared);
+        }
+        dealer->offer[numOffered++] = *c;
+    }
+    dealer->offer[numOffered] = '\0';
+}
+
+/**
+ * Checks whether a player program is a plugin to run in the dealer itself
+ * @param program the player program
+ * @returns true iff it names a shared object
+ */
+bool is_plugin(char* program) {
+    size_t length = strlen(program);
+    size_t suffixLength = strlen(PLUGIN_SUFFIX);
+    return length > suffixLength
+            && strcmp(program + length - suffixLength, PLUGIN_SUFFIX) == 0;
+}
+
+/**
+ * Loads the players which are plugins. Their move logic is called on the
+ * dealer's own game at their turn, so they need no process, pipes or
+ * messages; they get no outbox, reader or pid.
+ * @param dealer pointer to main dealer struct
+ */
+void load_plugins(Dealer* dealer) {
+    int numPlayers = dealer->game.numPlayers;
+    dealer->moveLogics = malloc(sizeof(MoveLogic) * numPlayers);
+    dealer->pluginHandles = malloc(sizeof(void*) * numPlayers);
+    for (int i = 0; i < numPlayers; i++) {
+        dealer->moveLogics[i] = NULL;
+        dealer->pluginHandles[i] = NULL;
+        if (!is_plugin(dealer->playerPrograms[i])) {
+            continue;
+        }
+        void* handle = dlopen(dealer->playerPrograms[i], RTLD_NOW);
+        if (handle == NULL) {
+            err_msg(BAD_PROCESS); // as if the program couldn't be run
+        }
+        // the POSIX way to get a function pointer from dlsym
+        *(void**) (&dealer->moveLogics[i]) = dlsym(handle, PLUGIN_SYMBOL);
+        if (dealer->moveLogics[i] == NULL) {
+            dlclose(handle);
+            err_msg(BAD_PROCESS);
+        }
+        dealer->pluginHandles[i] = handle;
+        dealer->playerPids[i] = -1;
+        dealer->dealerToPlayer[i][WRITE_END] = -1;
+        dealer->playerToDealer[i][READ_END] = -1;
+        init_outbox(&dealer->outboxes[i], -1);
+        dealer->outboxes[i].broken = true; // messages to it are dropped
+        init_line_reader(&dealer->playerToDealerReaders[i], -1);
+    }
+}
+
 /**
  * Sets up the signal handlers
  * Code from sig.c in lecture 5.2
@@ -99,6 +227,9 @@ void setup_signal_handlers(void) {
  * @param s the signal being sent to 2310dealer
  */
 void handle_signals(int s) {
+    if (globalDealer == NULL) {
+        return; // the game is over; nothing to clean up
+    }
     if (s == SIGHUP) {
         kill_all_children(globalDealer);
         exit(BAD_PROCESS); // exit status not checked; don't print message
@@ -118,48 +249,104 @@ void handle_signals(int s) {
  */
 void create_pipes(Dealer* dealer) {
     for (int i = 0; i < dealer->game.numPlayers; i++) {
-        if (pipe(dealer->dealerToPlayer[i]) != 0
-                || pipe(dealer->playerToDealer[i]) != 0) {
-            exit(BAD_PROCESS); // error creating the pipes
+        if (dealer->moveLogics[i] == NULL) {
+            create_player_pipes(dealer, i);
         }
     }
 }
 
+/**
+ * Creates the pipes between the dealer and one player process
+ * @param dealer the main dealer struct
+ * @param id the player
+ */
+void create_player_pipes(Dealer* dealer, int id) {
+    if (pipe(dealer->dealerToPlayer[id]) != 0
+            || pipe(dealer->playerToDealer[id]) != 0) {
+        exit(BAD_PROCESS); // error creating the pipes
+    }
+    // players only keep their own ends (as stdin and stdout) after
+    // exec, so each sees EOF as soon as the dealer is gone
+    for (int end = READ_END; end <= WRITE_END; end++) {
+        fcntl(dealer->dealerToPlayer[id][end], F_SETFD, FD_CLOEXEC);
+        fcntl(dealer->playerToDealer[id][end], F_SETFD, FD_CLOEXEC);
+    }
+}
+
 /**
  * Creates the player processes for the game
+ * @param dealer the main dealer struct
+ */
+void create_players(Dealer* dealer) {
+    for (int i = 0; i < dealer->game.numPlayers; i++) {
+        if (dealer->moveLogics[i] == NULL) {
+            create_player(dealer, i);
+        }
+    }
+}
+
+/**
+ * Creates one player process, from the program given for it
  * Redirects pipes and closes unnecessary ends of pipes
  * @param dealer the main dealer struct
- * @param playerPrograms the programs that will act as players
+ * @param id the player
  */
-void create_players(Dealer* dealer, char** playerPrograms) {
-    pid_t pid;
+void create_player(Dealer* dealer, int id) {
+    char* program = dealer->playerPrograms[id];
     pid_t ppid = getpid(); // get parent id 
-    for (int i = 0; i < dealer->game.numPlayers; i++) {
-        pid = fork(); // should handle a pid of -1
-        if (pid == 0) {
-            // child
-            close(dealer->dealerToPlayer[i][WRITE_END]);
-            close(dealer->playerToDealer[i][READ_END]);
-            redirect_child_fds(dealer, i);
-            int err = execlp(playerPrograms[i], playerPrograms[i],
-                    int_to_string(dealer->game.numPlayers),
-                    int_to_string(i), NULL); 
-            if (err == -1) {
-                kill(ppid, SIGHUP);
-                err_msg(BAD_PROCESS);
-            }
-        } else {
-            // parent
-            dealer->playerPids[i] = pid;
-            close(dealer->dealerToPlayer[i][READ_END]);
-            close(dealer->playerToDealer[i][WRITE_END]);
-            // creating streams so I don't have to dup on the dealer end
-            dealer->dealerToPlayerStreams[i]
-                    = fdopen(dealer->dealerToPlayer[i][WRITE_END], "w");
-            dealer->playerToDealerStreams[i]
-                    = fdopen(dealer->playerToDealer[i][READ_END], "r");
+    pid_t pid = fork(); // should handle a pid of -1
+    if (pid == 0) {
+        // child
+        close(dealer->dealerToPlayer[id][WRITE_END]);
+        close(dealer->playerToDealer[id][READ_END]);
+        redirect_child_fds(dealer, id);
+        set_child_offer(dealer);
+        int err = execlp(program, program,
+                int_to_string(dealer->game.numPlayers),
+                int_to_string(id), NULL); 
+        if (err == -1) {
+            kill(ppid, SIGHUP);
+            err_msg(BAD_PROCESS);
         }
+    } else {
+        // parent
+        dealer->playerPids[id] = pid;
+        close(dealer->dealerToPlayer[id][READ_END]);
+        close(dealer->playerToDealer[id][WRITE_END]);
+        // the dealer's ends are non-blocking, so no player can hold
+        // up the others
+        fcntl(dealer->dealerToPlayer[id][WRITE_END], F_SETFL, O_NONBLOCK);
+        fcntl(dealer->playerToDealer[id][READ_END], F_SETFL, O_NONBLOCK);
+        init_outbox(&dealer->outboxes[id],
+                dealer->dealerToPlayer[id][WRITE_END]);
+        init_line_reader(&dealer->playerToDealerReaders[id],
+                dealer->playerToDealer[id][READ_END]);
+    }
+}
+
+/**
+ * Replaces a player process which can't play another game with a new one
+ * (which still has to be sent the path)
+ * @param dealer the main dealer struct
+ * @param id the player
+ */
+void restart_player(Dealer* dealer, int id) {
+    kill(dealer->playerPids[id], SIGKILL);
+    waitpid(dealer->playerPids[id], NULL, 0);
+    close(dealer->dealerToPlayer[id][WRITE_END]);
+    close(dealer->playerToDealer[id][READ_END]);
+    free_outbox(&dealer->outboxes[id]);
+    free_line_reader(&dealer->playerToDealerReaders[id]);
+    // the new process decides on its own features
+    if (uses_shared_link(dealer->shared, id)) {
+        detach_shared_player(dealer->shared, id);
+    }
+    if (dealer->batching[id]) {
+        dealer->batching[id] = false;
+        dealer->numBatching--;
     }
+    create_player_pipes(dealer, id);
+    create_player(dealer, id);
 }
 
 /**
@@ -174,33 +361,330 @@ void redirect_child_fds(Dealer* dealer, int childNumber) {
     dup2(devNull, STDERR_FILENO);
 }
 
+/**
+ * Tells a player process about to be started what it is offered
+ * @param dealer the main dealer struct
+ */
+void set_child_offer(Dealer* dealer) {
+    if (dealer->offer[0] == '\0') {
+        unsetenv(OFFER_VARIABLE); // in case the dealer was given them
+        unsetenv(SHARED_MEMORY_VARIABLE);
+        return;
+    }
+    setenv(OFFER_VARIABLE, dealer->offer, 1);
+    if (dealer->shared == NULL) {
+        unsetenv(SHARED_MEMORY_VARIABLE);
+        return;
+    }
+    // the region has to stay open across exec for the player to map it
+    fcntl(dealer->shared->memoryFd, F_SETFD, 0);
+    fcntl(dealer->shared->notifyFd, F_SETFD, 0);
+    setenv(SHARED_MEMORY_VARIABLE, dealer->sharedDescription, 1);
+}
+
 /**
 * For each player, checks that it has recieved the '^' from them.
-* When it has, it sends the path back to the players
+* When it has, it sends the path back to the players. All players are
+* waited on at once, so slow starters don't hold up the others.
+* A player offered features can instead send '+', then the features it
+* accepts (a letter each) and a new line.
 * @param Dealer pointer to main dealer struct
+* @param starting the players which have just been started
 */
-void send_players_path(Dealer* dealer) {
+void send_players_path(Dealer* dealer, bool* starting) {
+    long long deadline = turn_deadline(dealer);
+    size_t pathLength = strlen(dealer->pathString);
+    int numWaiting = 0;
+    // players part way through sending the features they accept
+    bool* negotiating = calloc(dealer->game.numPlayers, sizeof(bool));
     for (int i = 0; i < dealer->game.numPlayers; i++) {
-        int c = fgetc(dealer->playerToDealerStreams[i]);
-        if (c == '^') {
-            send_message(dealer->dealerToPlayerStreams[i],
-                    dealer->pathString);
-        } else {
-            // both EOF or garbage char means bad process
-            kill_all_children(dealer); // necessary?
+        dealer->awaiting[i] = starting[i];
+        dealer->inputReady[i] = starting[i];
+        numWaiting += starting[i];
+    }
+    while (numWaiting > 0) {
+        for (int i = 0; i < dealer->game.numPlayers; i++) {
+            if (!dealer->awaiting[i] || !dealer->inputReady[i]) {
+                continue;
+            }
+            dealer->inputReady[i] = false;
+            LineReader* reader = &dealer->playerToDealerReaders[i];
+            int c = negotiating[i] ? '+' : read_char(reader);
+            if (c == '+' && dealer->offer[0] != '\0') {
+                negotiating[i] = true;
+                bool eof;
+                char* features = read_line(reader, &eof);
+                if (features == NULL) {
+                    continue; // the rest of the line isn't here yet
+                }
+                negotiating[i] = false;
+                c = (!eof && accept_features(dealer, i, features)) ? '^' : EOF;
+            }
+            if (c == '^') {
+                // every player gets the same path, so it isn't copied
+                queue_borrowed_message(&dealer->outboxes[i],
+                        dealer->pathString, pathLength);
+                dealer->awaiting[i] = false;
+                numWaiting--;
+            } else if (c != WOULD_BLOCK) {
+                // both EOF or garbage char means bad process
+                kill_all_children(dealer);
+                err_msg(BAD_PROCESS);
+            }
+        }
+        if (numWaiting > 0 && !poll_players(dealer, deadline)) {
+            kill_all_children(dealer); // a player never said it was ready
             err_msg(BAD_PROCESS);
         }
     }
+    free(negotiating);
+    if (!flush_all_outboxes(dealer, deadline)) {
+        kill_all_children(dealer);
+        err_msg(BAD_PROCESS);
+    }
+}
+
+/**
+ * Sets up the next game on the same path, once the last has finished.
+ * Players which accepted being reused are sent "NEW" and the path; the
+ * others are replaced with new processes.
+ * @param dealer pointer to main dealer struct
+ */
+void start_next_game(Dealer* dealer) {
+    flush_all_outboxes(dealer, turn_deadline(dealer)); // the last DONE
+    reset_game(&dealer->game);
+    bool* starting = calloc(dealer->game.numPlayers, sizeof(bool));
+    bool restarting = false;
+    for (int i = 0; i < dealer->game.numPlayers; i++) {
+        if (dealer->moveLogics[i] != NULL) {
+            continue; // plugins play on the dealer's game, just reset
+        }
+        if (dealer->reusable[i]) {
+            queue_message(&dealer->outboxes[i], dealer->newGameMessage);
+        } else {
+            restart_player(dealer, i);
+            starting[i] = restarting = true;
+        }
+    }
+    if (restarting) {
+        send_players_path(dealer, starting);
+    }
+    free(starting);
+}
+
+/**
+ * Accepts the features a player has said it will use
+ * @param dealer pointer to main dealer struct
+ * @param id the player
+ * @param features the features, a letter each, up to the end of the line
+ * @returns false if the player accepted something it wasn't offered
+ */
+bool accept_features(Dealer* dealer, int id, char* features) {
+    for (char* c = features; *c != '\n' && *c != '\0'; c++) {
+        if (strchr(dealer->offer, *c) == NULL) {
+            return false;
+        }
+        if (*c == FEATURE_SHARED_MEMORY) {
+            attach_shared_player(dealer->shared, id);
+        } else if (*c == FEATURE_BATCHED_HAPS && !dealer->batching[id]) {
+            dealer->batching[id] = true;
+            dealer->numBatching++;
+        } else if (*c == FEATURE_REUSABLE) {
+            dealer->reusable[id] = true;
+        }
+    }
+    return true;
 }
 
 /**
- * Sends a message to all players
+ * Sends a message to all players; those using the shared region all get
+ * it from there at once, and HAP messages for those batching are held
+ * until their next YT or the end of the game
  * @param dealer pointer to the main dealer struct
  * @param message the message to be sent to all players
  */
-void send_all_players_message(Dealer* dealer, char* message) {
+void send_all_players_message(Dealer* dealer, Message* message) {
+    char text[MAX_HAP_LEN];
+    format_message(text, message);
+    bool hap = (message->messageType == HAP);
+    if (hap && dealer->numBatching > 0) {
+        log_batched_hap(dealer, message);
+    }
     for (int i = 0; i < dealer->game.numPlayers; i++) {
-        send_message(dealer->dealerToPlayerStreams[i], message);
+        if (uses_shared_link(dealer->shared, i)
+                || (hap && dealer->batching[i])) {
+            continue;
+        }
+        if (dealer->batching[i]) {
+            send_hap_batch(dealer, i); // before the game's end
+        }
+        queue_message(&dealer->outboxes[i], text);
+    }
+    if (dealer->shared == NULL) {
+        return;
+    }
+    if (message->messageType == EARLY) {
+        post_early_game_over(dealer->shared);
+    } else {
+        publish_shared_event(dealer, message);
+    }
+}
+
+/**
+ * Adds a HAP message to the log batching players are sent from, first
+ * dropping what they have all been sent if the log is full
+ * @param dealer pointer to the main dealer struct
+ * @param hap the message
+ */
+void log_batched_hap(Dealer* dealer, Message* hap) {
+    HapLog* log = &dealer->hapLog;
+    if (hap_log_full(log)) {
+        size_t oldest = log->base + log->length;
+        for (int i = 0; i < dealer->game.numPlayers; i++) {
+            if (dealer->batching[i] && !uses_shared_link(dealer->shared, i)
+                    && dealer->delivered[i] < oldest) {
+                oldest = dealer->delivered[i];
+            }
+        }
+        trim_hap_log(log, oldest);
+    }
+    log_hap(log, hap->params);
+}
+
+/**
+ * Queues the HAP messages a batching player hasn't been sent yet, as one
+ * message; it's written along with the next message queued for them
+ * @param dealer pointer to the main dealer struct
+ * @param id the player
+ */
+void send_hap_batch(Dealer* dealer, int id) {
+    queue_hap_batch(&dealer->outboxes[id], &dealer->hapLog,
+            &dealer->delivered[id]);
+}
+
+/**
+ * Publishes a HAP message through the shared region, first waiting for
+ * room in its ring if a player using it has fallen behind. Players which
+ * have gone stop being waited for.
+ * @param dealer pointer to the main dealer struct
+ * @param event the message
+ */
+void publish_shared_event(Dealer* dealer, Message* event) {
+    long long deadline = turn_deadline(dealer);
+    while (!publish_event(dealer->shared, event)) {
+        for (int i = 0; i < dealer->game.numPlayers; i++) {
+            dealer->awaiting[i] = uses_shared_link(dealer->shared, i);
+        }
+        if (!poll_players(dealer, deadline)) {
+            early_game_over(dealer); // a player stopped reading
+        }
+        for (int i = 0; i < dealer->game.numPlayers; i++) {
+            if (dealer->awaiting[i]
+                    && (dealer->pollFds[2 * i].revents & POLLHUP)) {
+                detach_shared_player(dealer->shared, i);
+            }
+            dealer->awaiting[i] = false;
+        }
+    }
+}
+
+/**
+ * Gets the current time
+ * @returns the time in milliseconds from a monotonic clock
+ */
+long long now_ms(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec * 1000LL + time.tv_nsec / 1000000;
+}
+
+/**
+ * Works out when a player asked for something now must have answered by
+ * @param dealer pointer to main dealer struct
+ * @returns the deadline (see now_ms), or -1 if there is no time limit
+ */
+long long turn_deadline(Dealer* dealer) {
+    if (dealer->turnTimeout == -1) {
+        return -1;
+    }
+    return now_ms() + dealer->turnTimeout;
+}
+
+/**
+ * Waits until a player the dealer is waiting on may have input (which is
+ * marked in inputReady), or a player with messages queued for it can take
+ * more of them (which are then written)
+ * @param dealer pointer to main dealer struct
+ * @param deadline when to give up waiting (see now_ms), -1 for never
+ * @returns false iff the deadline passed
+ */
+bool poll_players(Dealer* dealer, long long deadline) {
+    bool waiting = false;
+    for (int i = 0; i < dealer->game.numPlayers; i++) {
+        struct pollfd* input = &dealer->pollFds[2 * i];
+        struct pollfd* output = &dealer->pollFds[2 * i + 1];
+        // poll ignores negative fds
+        input->fd = dealer->awaiting[i]
+                ? dealer->playerToDealer[i][READ_END] : -1;
+        input->events = POLLIN;
+        output->fd = outbox_pending(&dealer->outboxes[i])
+                ? dealer->outboxes[i].fd : -1;
+        output->events = POLLOUT;
+        waiting = waiting || input->fd != -1 || output->fd != -1;
+    }
+    struct pollfd* notify = &dealer->pollFds[2 * dealer->game.numPlayers];
+    notify->fd = (dealer->shared != NULL) ? dealer->shared->notifyFd : -1;
+    notify->events = POLLIN;
+    waiting = waiting || notify->fd != -1;
+    if (!waiting) {
+        return true;
+    }
+    int timeout = -1;
+    if (deadline != -1) {
+        long long left = deadline - now_ms();
+        timeout = (left > 0) ? left : 0;
+    }
+    int numReady = poll(dealer->pollFds, dealer->game.numPlayers * 2 + 1,
+            timeout);
+    if (numReady == 0) {
+        return false;
+    }
+    for (int i = 0; numReady > 0 && i < dealer->game.numPlayers; i++) {
+        if (dealer->pollFds[2 * i].revents != 0) {
+            dealer->inputReady[i] = true; // includes hang ups and errors
+        }
+        if (dealer->pollFds[2 * i + 1].revents != 0) {
+            flush_outbox(&dealer->outboxes[i]);
+        }
+    }
+    if (notify->revents != 0) {
+        clear_notifications(dealer->shared);
+    }
+    return true; // including when poll was interrupted by a signal
+}
+
+/**
+ * Waits until every message queued for the players has been written (or
+ * can't be, as the player has gone)
+ * @param dealer pointer to main dealer struct
+ * @param deadline when to give up waiting (see now_ms), -1 for never
+ * @returns false iff the deadline passed first
+ */
+bool flush_all_outboxes(Dealer* dealer, long long deadline) {
+    for (int i = 0; i < dealer->game.numPlayers; i++) {
+        dealer->awaiting[i] = false;
+    }
+    while (true) {
+        bool pending = false;
+        for (int i = 0; i < dealer->game.numPlayers && !pending; i++) {
+            pending = outbox_pending(&dealer->outboxes[i]);
+        }
+        if (!pending) {
+            return true;
+        }
+        if (!poll_players(dealer, deadline)) {
+            return false;
+        }
     }
 }
 
@@ -209,7 +693,7 @@ void send_all_players_message(Dealer* dealer, char* message) {
  * @param dealer pointer to main dealer struct
  */
 void play(Dealer* dealer) {
-    print_path(dealer->game, stdout);
+    show_path(stdout, dealer->output, &dealer->game);
     bool gameOver = false;
     while(!gameOver) {
         gameOver = turn(dealer);
@@ -233,56 +717,110 @@ bool turn(Dealer* dealer) {
     if (id == -1) {
         return true; // the game is over
     }
-    // request input from player
-    send_message(dealer->dealerToPlayerStreams[id], "YT");
-    // get move from player
-    Message move = get_message(dealer->playerToDealerStreams[id],
-            &decode_player_message);
+    Message move;
+    if (dealer->moveLogics[id] != NULL) {
+        move = get_plugin_move(dealer, id);
+    } else {
+        // request input from player
+        if (uses_shared_link(dealer->shared, id)) {
+            post_turn(dealer->shared, id);
+        } else {
+            if (dealer->batching[id]) {
+                send_hap_batch(dealer, id); // everything that happened since
+            }
+            queue_message(&dealer->outboxes[id], "YT");
+        }
+        // get move from player
+        move = get_move(dealer, id);
+    }
     if (move.error) {
         early_game_over(dealer);
     }
+    if (move.params[0] < 0 || move.params[0] >= dealer->game.path.size) {
+        early_game_over(dealer); // not a site on the path
+    }
     // find the player struct from id
     Player* p = find_player(&dealer->game, id, DEALER_COM_ERROR);
-    Site* s = &dealer->game.path.sites[move.params[0]];
-    int* hapParams = create_hap_params(dealer, p, s);
+    int site = move.params[0];
+    Message hap = create_hap(dealer, p, site);
     // update game and player information
-    update(dealer, p, s, hapParams);    
-    // create HAP message and send it to all players
-    char* hapMsg = create_hap_message(hapParams);
-    send_all_players_message(dealer, hapMsg);
-    print_player_info(stdout, p);
-    print_path(dealer->game, stdout);
+    update(dealer, p, site, &hap);
+    // send the HAP message to all players
+    send_all_players_message(dealer, &hap);
+    show_player(stdout, dealer->output, p);
+    show_path(stdout, dealer->output, &dealer->game);
     if (move.eof) {
         // if we find EOF, we process the message
         // and then exit with early game over
         early_game_over(dealer);
     }
-    free(move.params);
-    free(hapMsg);
-    free(hapParams);
     return false;
 }
 
+/**
+ * Waits for a player's move, writing messages to the other players in the
+ * mean time. If the player doesn't answer before the turn's deadline, the
+ * game ends early. A player using the shared region answers there, but its
+ * pipe is still watched so it hanging up is noticed.
+ * @param dealer pointer to main dealer struct
+ * @param id the player whose move it is
+ * @returns the decoded move
+ */
+Message get_move(Dealer* dealer, int id) {
+    long long deadline = turn_deadline(dealer);
+    LineReader* reader = &dealer->playerToDealerReaders[id];
+    bool shared = uses_shared_link(dealer->shared, id);
+    bool eof;
+    char* line;
+    int site;
+    dealer->awaiting[id] = true;
+    while ((line = read_line(reader, &eof)) == NULL) {
+        if (shared && take_move(dealer->shared, id, &site)) {
+            dealer->awaiting[id] = false;
+            Message move = create_message(DO);
+            move.numParams = 1;
+            move.params[0] = site;
+            return move;
+        }
+        if (!poll_players(dealer, deadline)) {
+            early_game_over(dealer); // too slow
+        }
+    }
+    dealer->awaiting[id] = false;
+    Message move = decode_player_message(line);
+    move.eof = eof;
+    return move;
+}
+
+/**
+ * Gets a plugin player's move, straight from its move logic
+ * @param dealer pointer to main dealer struct
+ * @param id the player whose move it is
+ * @returns the move, as if the player had sent it
+ */
+Message get_plugin_move(Dealer* dealer, int id) {
+    Player* player = find_player(&dealer->game, id, DEALER_COM_ERROR);
+    Message move = create_message(DO);
+    move.numParams = 1;
+    move.params[0] = dealer->moveLogics[id](&dealer->game, player);
+    return move;
+}
+
 /**
  * Updates the sate of the game and the player after a move occurs
  * @param dealer pointer to main dealer struct
  * @param player pointer to the player to be updated
- * @param newSite pointer to the new site the player arrived at
- * @param hapParams "array" with the parameters of the HAP message
+ * @param newSite the new site the player arrived at
+ * @param hap the HAP message describing the move
  */
-void update(Dealer* dealer, Player* player, Site* newSite, int* hapParams) {
+void update(Dealer* dealer, Player* player, int newSite, Message* hap) {
     // move player (i.e. update the game)
     if (!move_player(&dealer->game, player, newSite)) {
         early_game_over(dealer);
     }
-    // creating a hap msg ourselves so we can use same player update code
-    // as the players. Looks pretty cringe, but saves me some time.
-    Message hapMsg;
-    hapMsg.eof = false;
-    hapMsg.messageType = HAP;
-    hapMsg.numParams = NUM_HAP_PARAMS;
-    hapMsg.params = hapParams;
-    update_player(player, *newSite, &hapMsg);
+    // the dealer applies its own HAP message, so it can use the same
+    // player update code as the players
+    update_player(&dealer->game, player, newSite, hap);
 }
 
 /**
@@ -292,14 +830,13 @@ void update(Dealer* dealer, Player* player, Site* newSite, int* hapParams) {
  * @returns playerId of the player farthest back on the path 
 */
 int find_farthest_back(Dealer* dealer) {
-    // size - 1 so we don't check the final barrier
-    for (int i = 0; i < dealer->game.path.size - 1; i++) {
-        if (dealer->game.path.sites[i].numPlayers > 0) {
-            return dealer->game.path.sites[i].
-                    playerIds[dealer->game.path.sites[i].numPlayers - 1];
-        }
+    Path* path = &dealer->game.path;
+    int rear = dealer->game.rearSite;
+    // everyone being at the final barrier means the game is over
+    if (rear == path->size - 1) {
+        return -1; // -1 means all players have reached barrier
     }
-    return -1; // -1 means all players have reached barrier 
+    return site_players(path, rear)[path->occupancy[rear] - 1];
 }
 
 /**
@@ -310,47 +847,37 @@ int find_farthest_back(Dealer* dealer) {
 Message decode_player_message(char* message) {
     Message msg;
     msg.error = false;
-    if (strlen(message) < 2) {
-        // < 3 because 'D' + 'O' + n (at least 1 digit)
-        // not necessarilly '\n' terminated, might be EOF terminated
-        msg.error = true;
-        return msg;
-    }
+    // not necessarilly '\n' terminated, might be EOF terminated
     if (message[0] != 'D' || message[1] != 'O') {
         msg.error = true;
         return msg;
     }
     msg.messageType = DO;
-    // if not EOF terminated, there should be a '\n' on end
-    // must be removed for proper parsing
-    if (message[strlen(message) - 1] == '\n') {
-        message = strtok(message, "\n"); // remove trailing new line char
-    }
-    int error;
-    int site = string_to_int(message + 2, &error); // + 2 removes 'DO'
-    if (error) {
-        msg.error = true;
-    }
     msg.numParams = 1;
-    msg.params = malloc(sizeof(int) * msg.numParams);
-    msg.params[0] = site;
+    // + 2 skips the 'DO'
+    msg.error = !parse_do_params(message + 2, msg.params);
     return msg;
 }
 
 /**
- * Creates an integer "array" with the hap parameters (in order)
+ * Creates the HAP message for a move.
+ * Note: Dealer reuses code from players, so it actually updates it's state
+ * with the HAP message as well just like players
  * @param dealer pointer to main dealer struct
  * @param player pointer to the player which made the move 
- * @param newSite pointer to the site the player moved to
- * @returns int "array" with the parameters for a HAP message representing
- * the move just made
+ * @param newSite the site the player moved to
+ * @returns HAP message representing the move just made
  */
-int* create_hap_params(Dealer* dealer, Player* player, Site* newSite) {
-    int* hapParams = malloc(sizeof(int) * NUM_HAP_PARAMS);
+Message create_hap(Dealer* dealer, Player* player, int newSite) {
+    Message hap;
+    hap.messageType = HAP;
+    hap.numParams = NUM_HAP_PARAMS;
+    hap.eof = false;
+    hap.error = false;
     int dPoints = 0; // change in points;
     int dMoney = 0; // change in money
     char cardDrawn = '0'; // the card drawn
-    switch (newSite->type) {
+    switch (dealer->game.path.types[newSite]) {
         case MO_SITE:
             dMoney = 3;
             break;
@@ -366,26 +893,12 @@ int* create_hap_params(Dealer* dealer, Player* player, Site* newSite) {
         default:
             break;    
     }
-    hapParams[0] = player->playerId;
-    hapParams[1] = newSite->siteNumber;
-    hapParams[2] = dPoints;
-    hapParams[3] = dMoney;
-    hapParams[4] = cardDrawn;
-    return hapParams;
-}
-
-/**
- * Creates the HAP message to be sent to the players.
- * Note: Dealer reuses code from players, so it actually updates it's state
- * with the HAP message as well just like players
- * @param hapParams the paramaters in the HAP message
- * @returns String HAP message to be sent to players 
- */
-char* create_hap_message(int* hapParams) {
-    char* hapMsg = malloc(sizeof(char) * MAX_HAP_LEN); // long enough
-    sprintf(hapMsg, "HAP%d,%d,%d,%d,%c", hapParams[0],
-            hapParams[1], hapParams[2], hapParams[3], hapParams[4]);
-    return hapMsg;
+    hap.params[0] = player->playerId;
+    hap.params[1] = newSite;
+    hap.params[2] = dPoints;
+    hap.params[3] = dMoney;
+    hap.params[4] = cardDrawn;
+    return hap;
 }
 
 /**
@@ -394,6 +907,9 @@ char* create_hap_message(int* hapParams) {
  */
 void kill_all_children(Dealer* dealer) {
     for (int i = 0; i < dealer->game.numPlayers; i++) {
+        if (dealer->playerPids[i] == -1) {
+            continue; // a plugin, not a process
+        }
         int status = 0;
         waitpid(dealer->playerPids[i], &status, WNOHANG);
         if (!WIFEXITED(status)) {
@@ -409,7 +925,9 @@ void kill_all_children(Dealer* dealer) {
  * @param dealer pointer to main dealer struct
  */
 void early_game_over(Dealer* dealer) {
-    send_all_players_message(dealer, "EARLY");
+    Message early = create_message(EARLY);
+    send_all_players_message(dealer, &early);
+    flush_all_outboxes(dealer, turn_deadline(dealer));
     err_msg(DEALER_COM_ERROR);
 }
 
@@ -421,15 +939,36 @@ void free_dealer(Dealer* dealer) {
     free_game(dealer->game);    
     free(dealer->deck.values);
     for (int i = 0; i < dealer->game.numPlayers; i++) {
-        fclose(dealer->dealerToPlayerStreams[i]);
-        fclose(dealer->playerToDealerStreams[i]);
+        close(dealer->dealerToPlayer[i][WRITE_END]);
+        close(dealer->playerToDealer[i][READ_END]);
+        free_outbox(&dealer->outboxes[i]);
+        free_line_reader(&dealer->playerToDealerReaders[i]);
         free(dealer->dealerToPlayer[i]);
         free(dealer->playerToDealer[i]);
     }
     free(dealer->dealerToPlayer);
     free(dealer->playerToDealer);
-    free(dealer->dealerToPlayerStreams);
-    free(dealer->playerToDealerStreams); 
+    free(dealer->outboxes);
+    free(dealer->awaiting);
+    free(dealer->inputReady);
+    free(dealer->pollFds);
+    free(dealer->playerToDealerReaders);
     free(dealer->pathString);
     free(dealer->playerPids);
+    free(dealer->batching);
+    free(dealer->delivered);
+    free_hap_log(&dealer->hapLog);
+    free(dealer->reusable);
+    for (int i = 0; i < dealer->game.numPlayers; i++) {
+        if (dealer->pluginHandles[i] != NULL) {
+            dlclose(dealer->pluginHandles[i]);
+        }
+    }
+    free(dealer->moveLogics);
+    free(dealer->pluginHandles);
+    free(dealer->newGameMessage);
+    if (dealer->shared != NULL) {
+        free_shared_link(dealer->shared);
+        free(dealer->sharedDescription);
+    }
 }
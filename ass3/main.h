@@ -4,6 +4,9 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <dlfcn.h>
 #include <signal.h>
 #include <sys/signal.h>
 #include <sys/types.h>
@@ -12,19 +15,59 @@
 #include "errs.h"
 #include "init.h"
 #include "communication.h"
+#include "shared.h"
 #include "utility.h"
 #include "logic.h"
 #include "constants.h"
 
+// milliseconds each player has to respond, unset for no limit
+#define TURN_TIMEOUT_VARIABLE "DEALER_TURN_TIMEOUT"
+// the protocol features the dealer offers players, unset for none
+#define FEATURES_VARIABLE "DEALER_FEATURES"
+// the features this dealer can offer
+#define SUPPORTED_FEATURES "SBR"
+// the number of games to play on the path, one after another
+#define GAMES_VARIABLE "DEALER_GAMES"
+// how much of the game is shown on stdout: "full", "events" or "quiet";
+// unset for full, or quiet when stdout is /dev/null
+#define OUTPUT_VARIABLE "DEALER_OUTPUT"
+// player programs ending with this are loaded into the dealer
+#define PLUGIN_SUFFIX ".so"
+// the function plugins export, a player's move_logic
+#define PLUGIN_SYMBOL "move_logic"
+
+// chooses the site a player moves to on its turn
+typedef int (*MoveLogic)(Game*, Player*);
+
 typedef struct {
     Game game; // main game struct
     Deck deck; // deck struct
     char* pathString; // the path in a string format
     int** dealerToPlayer; // dealer to player file descriptors
     int** playerToDealer; // player to dealer file descriptors
-    FILE** dealerToPlayerStreams; // dealer to player streams
-    FILE** playerToDealerStreams; // player to dealer streams
+    Outbox* outboxes; // messages waiting to be written to each player
+    LineReader* playerToDealerReaders; // readers for player to dealer pipes
+    bool* awaiting; // the players the dealer is waiting to hear from
+    bool* inputReady; // awaited players whose pipes may have input
+    // [2i] is player i's input and [2i+1] its output; the last one is for
+    // notifications from players using the shared region
+    struct pollfd* pollFds;
+    char offer[MAX_FEATURES + 1]; // the features offered to players
+    SharedLink* shared; // the shared region, NULL if it wasn't offered
+    char* sharedDescription; // where players find the shared region
+    bool* batching; // players which get HAP messages in batches
+    int numBatching; // the number of players batching
+    HapLog hapLog; // HAP messages not yet sent to every batching player
+    size_t* delivered; // how much of hapLog each batching player was sent
+    int turnTimeout; // milliseconds a player has to respond, -1 for no limit
     pid_t* playerPids; // process ids for the players
+    char** playerPrograms; // the programs the players are run from
+    int numGames; // the number of games to play
+    bool* reusable; // players which can be sent another game
+    char* newGameMessage; // the message starting another game
+    MoveLogic* moveLogics; // plugin players' move logic, NULL for processes
+    void** pluginHandles; // the loaded plugins, NULL for processes
+    OutputMode output; // how much of the game is shown on stdout
     bool gameStarted; // true iff all players have sent '^' to stdout
 } Dealer;
 
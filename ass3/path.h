@@ -1,6 +1,8 @@
 #ifndef PATH_H
 #define PATH_H
 
+#include "constants.h"
+
 typedef enum {
     MO_SITE = 0, // The Mo site
     V1_SITE = 1, // The V1 site
@@ -10,17 +12,18 @@ typedef enum {
     BAR_SITE = 5 // The barrier site, i.e. "::"
 } SiteType;
 
-typedef struct {
-    SiteType type; // the type of site this site is
-    int siteNumber; // the number site this is in the path
-    int* playerIds; // playerIds in order of the players at this site
-    int capacity; // the capacity of this site
-    int numPlayers; // the number of players at this site
-} Site;
-
+// Sites are known by their index in the path; each array below has an
+// entry per site, and they all live in one allocation starting at types
 typedef struct {
     int size; // the number of sites in this path
-    Site* sites;
+    SiteType* types; // the type of each site
+    int* capacities; // the most players each site can hold
+    int* occupancy; // the number of players at each site
+    int* firstSlot; // where each site's players start in playerIds
+    int* playerIds; // every site's players, each in order of arrival
+    // nextSite[type][i] is the first site of type at or after site i, or -1;
+    // each has size + 1 entries
+    int* nextSite[NUM_SITE_TYPES];
 } Path;
 
 typedef struct {
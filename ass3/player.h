@@ -1,6 +1,8 @@
 #ifndef PLAYER_H
 #define PLAYER_H
 
+#include "constants.h"
+
 typedef enum {
     A = 0, // the index of A in cards array
     B = 1, // the index of B in cards array
@@ -16,7 +18,7 @@ typedef struct {
     int v1; // the number of v1 type sites this player has visited
     int v2; // the number of v2 type sites this player has visited
     int points; // the number of points this player has
-    int* cards; // array with cards the player has
+    int cards[NUM_TYPE_CARD]; // how many of each card the player has
 } Player;
 
 #endif
\ No newline at end of file
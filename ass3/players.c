@@ -8,10 +8,18 @@
  */
 void run(int argc, char** argv, int (*moveLogic)(Game*, Player*)) {
     ProgramInfo info = check_args(argc, argv);
-    ready();
-    Game game = init_game(stdin, info.numPlayers, false);
-    play(moveLogic, &game, info.id);
-    finish(game);
+    Connection connection;
+    connection.output = choose_output_mode(stderr, OUTPUT_VARIABLE);
+    ready(&connection, info.id);
+    // the path always comes down stdin, whatever was accepted
+    init_line_reader(&connection.reader, STDIN_FILENO);
+    connection.pathString = init_path_string(&connection.reader);
+    Game game = init_game(connection.pathString, info.numPlayers, false);
+    if (connection.shared != NULL) {
+        catch_up_shared_link(connection.shared);
+    }
+    play(moveLogic, &game, info.id, &connection);
+    finish(game, &connection);
 }
 
 /**
@@ -38,10 +46,42 @@ ProgramInfo check_args(int argc, char** argv) {
 }
 
 /**
- * Tells the dealer that this player is ready to receive path
+ * Tells the dealer that this player is ready to receive path. If the dealer
+ * offered its shared region, and it can be used, the player accepts it;
+ * otherwise it accepts batched HAP messages if they were offered. It also
+ * accepts playing more games if offered.
+ * @param connection set up with how messages will get to the player
+ * @param id the id of the player this program is playing as
  */
-void ready(void) {
-    fprintf(stdout, "^");
+void ready(Connection* connection, int id) {
+    char* offer = getenv(OFFER_VARIABLE);
+    char* description = getenv(SHARED_MEMORY_VARIABLE);
+    char accepted[MAX_FEATURES + 1];
+    int numAccepted = 0;
+    connection->shared = NULL;
+    connection->batched = false;
+    connection->batch = NULL;
+    connection->reusable = false;
+    if (offer != NULL && description != NULL
+            && strchr(offer, FEATURE_SHARED_MEMORY) != NULL) {
+        connection->shared = join_shared_link(description, id);
+    }
+    if (connection->shared != NULL) {
+        accepted[numAccepted++] = FEATURE_SHARED_MEMORY;
+    } else if (offer != NULL && strchr(offer, FEATURE_BATCHED_HAPS) != NULL) {
+        connection->batched = true;
+        accepted[numAccepted++] = FEATURE_BATCHED_HAPS;
+    }
+    if (offer != NULL && strchr(offer, FEATURE_REUSABLE) != NULL) {
+        connection->reusable = true;
+        accepted[numAccepted++] = FEATURE_REUSABLE;
+    }
+    accepted[numAccepted] = '\0';
+    if (numAccepted > 0) {
+        fprintf(stdout, "+%s\n", accepted);
+    } else {
+        fprintf(stdout, "^");
+    }
     fflush(stdout);
 }
 
@@ -51,11 +91,13 @@ void ready(void) {
  * @param move_logic the logic function for the player; different for A and B
  * @param game the game struct
  * @param player the player that the calling program is playing as
+ * @param connection how messages get to and from the dealer
  */
-void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId) {
-    print_path(*game, stderr);
+void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId,
+        Connection* connection) {
+    show_path(stderr, connection->output, game);
     while(1) {
-        Message message = get_message(stdin, &decode_dealer_message);
+        Message message = receive_message(connection);
         Player* p = find_player(game, playerId, PLAYER_COM_ERROR);
         int site;
         switch(message.messageType) {
@@ -63,20 +105,21 @@ void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId) {
                 site = moveLogic(game, p);
                 // if player is on the last site, it shouldn't be sent
                 // a YT message
-                if (p->site ==
-                        game->path.sites[game->path.size - 1].siteNumber) {
+                if (p->site == game->path.size - 1) {
                     err_msg(PLAYER_COM_ERROR);
                 }
-                fprintf(stdout, "DO%d\n", site);
-                fflush(stdout);
+                send_move(connection, site);
                 break;
             case EARLY:
-                finish(*game);
+                finish(*game, connection);
                 break;    
             case DONE:
                 distribute_extra_points(game);
                 print_scores(game, stderr);
-                finish(*game);
+                if (!connection->reusable) {
+                    finish(*game, connection);
+                }
+                next_game(game, connection);
                 break;
             case HAP:
                 if (!is_valid_hap(message, *game)) {
@@ -85,9 +128,12 @@ void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId) {
                 // will need to print info of other play that isn't us.
                 p = find_player(game, message.params[0], PLAYER_COM_ERROR);
                 update(game, message);
-                print_player_info(stderr, p);
-                print_path(*game, stderr);
+                show_player(stderr, connection->output, p);
+                show_path(stderr, connection->output, game);
                 break;                    
+            case HAPS:
+                apply_hap_batch(game, connection);
+                break;
             default:
                 err_msg(PLAYER_COM_ERROR);
                 break;   
@@ -98,6 +144,50 @@ void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId) {
     }
 }
 
+/**
+ * Gets the next message from the dealer
+ * @param connection how messages get from the dealer
+ * @returns the decoded message
+ */
+Message receive_message(Connection* connection) {
+    if (connection->shared != NULL) {
+        Message message = next_shared_message(connection->shared);
+        if (message.error) {
+            err_msg(PLAYER_COM_ERROR); // the dealer has gone
+        }
+        return message;
+    }
+    if (!connection->batched) {
+        return get_message(&connection->reader, &decode_dealer_message);
+    }
+    bool eof;
+    char* line = read_line(&connection->reader, &eof);
+    Message message;
+    if (line != NULL && strncmp(line, "HAPS", 4) == 0) {
+        message = create_message(HAPS);
+        connection->batch = line + 4; // + 4 skips the "HAPS"
+    } else {
+        message = decode_dealer_message(line);
+    }
+    message.eof = eof;
+    return message;
+}
+
+/**
+ * Answers a YT message with a DO message
+ * @param connection how messages get to the dealer
+ * @param site the site to move to
+ */
+void send_move(Connection* connection, int site) {
+    if (connection->shared != NULL) {
+        post_move(connection->shared, site);
+        return;
+    }
+    char doMessage[MAX_DO_LEN];
+    format_do_message(doMessage, site);
+    send_message(stdout, doMessage);
+}
+
 /**
  * Updates Game and Player struct after a HAP message
  * @param game the game struct
@@ -105,12 +195,37 @@ void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId) {
  */
 void update(Game* game, Message message) {
     Player* player = find_player(game, message.params[0], PLAYER_COM_ERROR);
-    Site* newSite = &game->path.sites[message.params[1]];
+    int newSite = message.params[1];
     if(!move_player(game, player, newSite)) {
         err_msg(PLAYER_COM_ERROR); // invalid HAP 
     }
-    update_player(player, game->path.sites[message.params[1]], &message);
-    free(message.params);
+    update_player(game, player, newSite, &message);
+}
+
+/**
+ * Applies a batch of HAP messages in one pass, then shows the path once
+ * @param game the game struct
+ * @param connection the connection the batch came from; its batch has the
+ * params of each HAP message, separated by ';'
+ */
+void apply_hap_batch(Game* game, Connection* connection) {
+    Message message = create_message(HAP);
+    message.numParams = NUM_HAP_PARAMS;
+    char* entry = connection->batch;
+    while (true) {
+        char* end = parse_hap_batch_entry(entry, message.params);
+        if (end == NULL || !is_valid_hap(message, *game)) {
+            err_msg(PLAYER_COM_ERROR);
+        }
+        update(game, message);
+        show_player(stderr, connection->output,
+                find_player(game, message.params[0], PLAYER_COM_ERROR));
+        if (*end != ';') {
+            break;
+        }
+        entry = end + 1;
+    }
+    show_path(stderr, connection->output, game);
 }
 
 /**
@@ -125,12 +240,13 @@ Message decode_dealer_message(char* message) {
         err_msg(PLAYER_COM_ERROR);
     }
     decodedMessage.messageType = decode_dealer_message_type(message);
+    decodedMessage.numParams = 0;
     if (decodedMessage.messageType == HAP) {
         decodedMessage.numParams = NUM_HAP_PARAMS;
         // + 3 gets rid of the 'HAP' at the start
-        decodedMessage.params = decode_hap_params(message + 3);
-    } else {
-        decodedMessage.numParams = 0;
+        if (!parse_hap_params(message + 3, decodedMessage.params)) {
+            err_msg(PLAYER_COM_ERROR);
+        }
     }
     return decodedMessage;
 }
@@ -141,85 +257,73 @@ Message decode_dealer_message(char* message) {
  * @returns the MessageType of the message sent by dealer to player
  */ 
 MessageType decode_dealer_message_type(char* message) {
-    // getting string portion of message (before params)
-    char word[strlen(message)];
-    for (int i = 0; i <= strlen(message); i++) {
-        if (isalpha(message[i])) {
-            word[i] = message[i];
-        } else {
-            word[i] = '\0';
-            break;
-        }
+    // the word is the letters before any params
+    int length = 0;
+    while (isalpha(message[length])) {
+        length++;
     }
-    MessageType type = -1; // an invalid type
-    int expectedLenth = 0;
-    if (strcmp(word, "YT") == 0) {
-        type = YT;
-        expectedLenth = 2; // "YT" is 2 chars  long. nO mAgIC nUmBeRS hErE!!
-    } 
-    if (strcmp(word, "EARLY") == 0) {
-        type = EARLY;
-        expectedLenth = 5; // "EARLY" is 5 chars long
-    } 
-    if (strcmp(word, "DONE") == 0) {
-        type = DONE;
-        expectedLenth = 4; // "DONE" is 4 chars long
-    } 
-    if (strcmp(word, "HAP") == 0) {
-        return HAP; // HAP msg validity is checked differently
-    }
-    strtok(message, "\n"); // gets rid of trailing new line
-    if (strlen(message) != expectedLenth) {
-        err_msg(PLAYER_COM_ERROR);
-    } else {
-        return type;
+    if (length == 3 && strncmp(message, "HAP", 3) == 0) {
+        return HAP; // HAP msg validity is checked with its params
+    }
+    // other messages have no params, so must end after the word
+    if (message[length] == '\0' || message[length] == '\n') {
+        if (length == 2 && strncmp(message, "YT", 2) == 0) {
+            return YT;
+        }
+        if (length == 5 && strncmp(message, "EARLY", 5) == 0) {
+            return EARLY;
+        }
+        if (length == 4 && strncmp(message, "DONE", 4) == 0) {
+            return DONE;
+        }
     }
+    err_msg(PLAYER_COM_ERROR);
     return -1; // unreachable, but compiler is triggered unless its here    
 }
 
 /**
- * Decodes hap params from dealer
- * @param message message from dealer minus the first three 'HAP' characters
- * @returns int* with params in it (in order that they were specified)
+ * Waits for the dealer to start another game after DONE: "NEW" and the
+ * path. The game is reset, and the path only decoded again if it changed.
+ * If the dealer has finished with this player instead, it exits.
+ * @param game the game struct, set up for the next game
+ * @param connection how messages get from the dealer
  */
-int* decode_hap_params(char* message) {
-    strtok(message, "\n"); // gets rid of trailing new line
-    int numCommas = 0;
-    for (int i = 0; i < strlen(message); i++) {
-        if (message[i] == ',') {
-            numCommas++;
-        }
+void next_game(Game* game, Connection* connection) {
+    bool eof;
+    char* line = read_line(&connection->reader, &eof);
+    if (line == NULL || (eof && line[0] == '\0')) {
+        finish(*game, connection); // no more games
     }
-    if (numCommas != 4) { // a valid HAP message will have 4 commas
+    if (eof || strncmp(line, "NEW", 3) != 0) {
         err_msg(PLAYER_COM_ERROR);
     }
-    int* params = (int*) malloc(sizeof(int) * NUM_HAP_PARAMS);
-    char* token = strtok(message, ",");
-    for (int i = 0; i < NUM_HAP_PARAMS; i++) {
-        int error;
-        if (i != 4) {
-            params[i] = string_to_int(token, &error);
-            if (error) {
-                err_msg(PLAYER_COM_ERROR);
-            }
-        } else {
-            if (token != NULL && strlen(token) == 1
-                    && is_valid_card(token[0])) {
-                params[4] = token[0];
-            } else {
-                err_msg(PLAYER_COM_ERROR);
-            }
-        }
-        token = strtok(NULL, ",");
+    char* pathString = line + 3; // + 3 skips the "NEW"
+    strtok(pathString, "\n"); // remove trailing new line
+    if (strcmp(pathString, connection->pathString) == 0) {
+        reset_game(game);
+    } else {
+        free(connection->pathString);
+        connection->pathString = malloc(sizeof(char)
+                * (strlen(pathString) + 1));
+        strcpy(connection->pathString, pathString);
+        int numPlayers = game->numPlayers;
+        free_game(*game);
+        *game = init_game(connection->pathString, numPlayers, false);
     }
-    return params;
+    show_path(stderr, connection->output, game);
 }
 
 /**
  * Exits program cleanly
  * @param game main game struct
+ * @param connection how messages got to and from the dealer
  */
-void finish(Game game) {
+void finish(Game game, Connection* connection) {
     free_game(game);
+    free_line_reader(&connection->reader);
+    free(connection->pathString);
+    if (connection->shared != NULL) {
+        free_shared_link(connection->shared);
+    }
     exit(GOOD);
 }
\ No newline at end of file
@@ -3,26 +3,46 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include "logic.h"
 #include "init.h"
 #include "errs.h"
 #include "utility.h"
 #include "communication.h"
+#include "shared.h"
 #include "constants.h"
 
+// how much of the game is shown on stderr: "full", "events" or "quiet";
+// unset for full, or quiet when stderr is /dev/null (as the dealer has it)
+#define OUTPUT_VARIABLE "PLAYER_OUTPUT"
+
 typedef struct {
     int numPlayers; // the number of players in the game
     int id; // the id of the player this program is playing as
 } ProgramInfo;
 
+typedef struct {
+    LineReader reader; // reads what the dealer sends down stdin
+    SharedLink* shared; // the dealer's shared region, NULL if not used
+    bool batched; // true iff HAP messages may come in batches
+    char* batch; // the latest batch's HAP params, until the next message
+    bool reusable; // true iff the dealer may send another game after DONE
+    char* pathString; // the path of the game being played
+    OutputMode output; // how much of the game is shown on stderr
+} Connection;
+
 void run(int argc, char** argv, int (*moveLogic)(Game*, Player*));
 ProgramInfo check_args(int argc, char** argv);
-void ready(void);
-void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId);
+void ready(Connection* connection, int id);
+void play(int (*moveLogic)(Game*, Player*), Game* game, int playerId,
+        Connection* connection);
+Message receive_message(Connection* connection);
+void send_move(Connection* connection, int site);
 void update(Game* game, Message message);
+void apply_hap_batch(Game* game, Connection* connection);
 Message decode_dealer_message(char* message);
 MessageType decode_dealer_message_type(char* message);
-int* decode_hap_params(char* message);
-void finish(Game game);
+void next_game(Game* game, Connection* connection);
+void finish(Game game, Connection* connection);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,430 @@
+#define _GNU_SOURCE // for memfd_create
+#include "shared.h"
+
+// private functions
+SharedLink* map_shared_link(int memoryFd, int notifyFd, size_t size,
+        int numPlayers);
+size_t shared_link_size(int numPlayers);
+bool ring_has_space(SharedLink* link);
+void wake_player(SharedLink* link, int id);
+void wake_players(SharedLink* link);
+void notify_dealer(SharedLink* link);
+bool dealer_gone(void);
+
+/**
+ * Works out how big the shared region is for a number of players
+ * @param numPlayers the number of players in the game
+ * @returns the size of the region in bytes
+ */
+size_t shared_link_size(int numPlayers) {
+    return sizeof(SharedHeader) + sizeof(Mailbox) * numPlayers
+            + sizeof(SharedEvent) * SHARED_RING_SIZE;
+}
+
+/**
+ * Maps a shared region into this process
+ * @param memoryFd the memfd holding the region
+ * @param notifyFd the eventfd used to wake the dealer
+ * @param size the size of the region
+ * @param numPlayers the number of mailboxes in the region
+ * @returns the link to the region, or NULL if it couldn't be mapped
+ */
+SharedLink* map_shared_link(int memoryFd, int notifyFd, size_t size,
+        int numPlayers) {
+    void* region = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+            memoryFd, 0);
+    if (region == MAP_FAILED) {
+        return NULL;
+    }
+    SharedLink* link = malloc(sizeof(SharedLink));
+    link->header = region;
+    link->mailboxes = (Mailbox*) (link->header + 1);
+    link->events = (SharedEvent*) (link->mailboxes + numPlayers);
+    link->size = size;
+    link->numPlayers = numPlayers;
+    link->memoryFd = memoryFd;
+    link->notifyFd = notifyFd;
+    link->id = -1;
+    link->consumed = 0;
+    link->turnsSeen = 0;
+    link->head = 0;
+    link->oldest = 0;
+    link->posted = NULL;
+    return link;
+}
+
+/**
+ * Creates the shared region the dealer offers to players. Players that
+ * accept it read HAP messages from one ring all of them share, and get YT
+ * messages and answer with DO messages through their own mailbox, instead
+ * of through their pipes.
+ * @param numPlayers the number of players in the game
+ * @returns the dealer's link to the region, or NULL if it couldn't be made
+ */
+SharedLink* create_shared_link(int numPlayers) {
+    size_t size = shared_link_size(numPlayers);
+    int memoryFd = memfd_create("2310dealer", MFD_CLOEXEC);
+    if (memoryFd == -1) {
+        return NULL;
+    }
+    int notifyFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (notifyFd == -1 || ftruncate(memoryFd, size) != 0) {
+        close(memoryFd);
+        if (notifyFd != -1) {
+            close(notifyFd);
+        }
+        return NULL;
+    }
+    SharedLink* link = map_shared_link(memoryFd, notifyFd, size,
+            numPlayers);
+    if (link == NULL) {
+        close(memoryFd);
+        close(notifyFd);
+        return NULL;
+    }
+    link->posted = calloc(numPlayers, sizeof(PostedMail));
+    return link;
+}
+
+/**
+ * Joins the shared region a player was offered by the dealer
+ * @param description the fds of the region, as describe_shared_link made
+ * @param id the player joining
+ * @returns the player's link to the region, or NULL if it can't be used
+ */
+SharedLink* join_shared_link(char* description, int id) {
+    int memoryFd;
+    int notifyFd;
+    char extra;
+    struct stat info;
+    if (sscanf(description, "%d,%d%c", &memoryFd, &notifyFd, &extra) != 2
+            || fstat(memoryFd, &info) != 0
+            || info.st_size < shared_link_size(id + 1)) {
+        return NULL;
+    }
+    // the size says how many mailboxes there are
+    int numPlayers = (info.st_size - shared_link_size(0)) / sizeof(Mailbox);
+    if (info.st_size != shared_link_size(numPlayers)) {
+        return NULL;
+    }
+    SharedLink* link = map_shared_link(memoryFd, notifyFd, info.st_size,
+            numPlayers);
+    if (link == NULL) {
+        return NULL;
+    }
+    link->id = id;
+    return link;
+}
+
+/**
+ * Unmaps the shared region and frees the link (closing its fds)
+ * @param link the link
+ */
+void free_shared_link(SharedLink* link) {
+    munmap(link->header, link->size);
+    close(link->memoryFd);
+    close(link->notifyFd);
+    free(link->posted);
+    free(link);
+}
+
+/**
+ * Describes the shared region so a player started by the dealer can find
+ * it (the dealer must also keep the fds open across exec for the player)
+ * @param link the dealer's link
+ * @returns the description, which must be freed
+ */
+char* describe_shared_link(SharedLink* link) {
+    // 2 ints, the ',' and the null terminator
+    char* description = malloc(num_digits(link->memoryFd)
+            + num_digits(link->notifyFd) + 2);
+    sprintf(description, "%d,%d", link->memoryFd, link->notifyFd);
+    return description;
+}
+
+/**
+ * Marks a player as using the shared region, once it has accepted it. The
+ * player starts with the next event published (it may be replacing a
+ * player which had used the mailbox before).
+ * @param link the dealer's link
+ * @param id the player
+ */
+void attach_shared_player(SharedLink* link, int id) {
+    Mailbox* mailbox = &link->mailboxes[id];
+    mailbox->turns = 0;
+    mailbox->moves = 0;
+    mailbox->turnAt = link->head;
+    mailbox->consumed = link->head;
+    link->posted[id].turns = 0;
+    link->posted[id].attached = true;
+}
+
+/**
+ * Stops counting a player as using the shared region, once it has gone
+ * (so the ring doesn't fill up waiting for it to read)
+ * @param link the dealer's link
+ * @param id the player
+ */
+void detach_shared_player(SharedLink* link, int id) {
+    link->posted[id].attached = false;
+}
+
+/**
+ * Checks if a player uses the shared region
+ * @param link the dealer's link, or NULL if the region wasn't offered
+ * @param id the player
+ * @returns true iff the player's messages go through the region
+ */
+bool uses_shared_link(SharedLink* link, int id) {
+    return link != NULL && link->posted[id].attached;
+}
+
+/**
+ * Checks whether there is room in the ring for another event, which there
+ * is unless some player that uses the region hasn't read the oldest one.
+ * If there isn't room, players are asked to notify the dealer when they
+ * read more, and those behind are woken to read.
+ * @param link the dealer's link
+ * @returns true iff an event can be published
+ */
+bool ring_has_space(SharedLink* link) {
+    uint64_t head = link->head;
+    if (head - link->oldest < SHARED_RING_SIZE) {
+        return true; // players have read enough, as of the last look
+    }
+    for (int tries = 0; tries < 2; tries++) {
+        uint64_t oldest = head;
+        for (int i = 0; i < link->numPlayers; i++) {
+            uint64_t consumed = __atomic_load_n(&link->mailboxes[i].consumed,
+                    __ATOMIC_SEQ_CST);
+            if (link->posted[i].attached && consumed < oldest) {
+                oldest = consumed;
+            }
+        }
+        link->oldest = oldest;
+        if (head - oldest < SHARED_RING_SIZE) {
+            __atomic_store_n(&link->header->spaceWanted, 0, __ATOMIC_SEQ_CST);
+            return true;
+        }
+        // look again after asking, in case a player read just before
+        __atomic_store_n(&link->header->spaceWanted, 1, __ATOMIC_SEQ_CST);
+    }
+    // players aren't woken for HAP messages, so those behind may be asleep
+    for (int i = 0; i < link->numPlayers; i++) {
+        if (link->posted[i].attached && head - __atomic_load_n(
+                &link->mailboxes[i].consumed, __ATOMIC_SEQ_CST)
+                >= SHARED_RING_SIZE) {
+            wake_player(link, i);
+        }
+    }
+    return false;
+}
+
+/**
+ * Wakes a player if it's asleep waiting for something to be posted. This
+ * is a store, and a system call only if the player is asleep.
+ * @param link the dealer's link
+ * @param id the player
+ */
+void wake_player(SharedLink* link, int id) {
+    Mailbox* mailbox = &link->mailboxes[id];
+    __atomic_add_fetch(&mailbox->wake, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&mailbox->sleeping, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &mailbox->wake, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+}
+
+/**
+ * Wakes every player using the region
+ * @param link the dealer's link
+ */
+void wake_players(SharedLink* link) {
+    for (int i = 0; i < link->numPlayers; i++) {
+        if (link->posted[i].attached) {
+            wake_player(link, i);
+        }
+    }
+}
+
+/**
+ * Publishes a HAP or DONE message to every player using the region at once.
+ * Players are only woken for DONE; they read the HAP messages before their
+ * next YT message, which does wake them.
+ * @param link the dealer's link
+ * @param event the message
+ * @returns false if the ring is full; the dealer should wait for a
+ * notification and try again
+ */
+bool publish_event(SharedLink* link, Message* event) {
+    if (!ring_has_space(link)) {
+        return false;
+    }
+    SharedEvent* slot = &link->events[link->head % SHARED_RING_SIZE];
+    slot->messageType = event->messageType;
+    memcpy(slot->params, event->params, sizeof(slot->params));
+    link->head++;
+    __atomic_store_n(&link->header->head, link->head, __ATOMIC_RELEASE);
+    if (event->messageType != HAP) {
+        wake_players(link);
+    }
+    return true;
+}
+
+/**
+ * Posts a YT message to a player's mailbox
+ * @param link the dealer's link
+ * @param id the player whose turn it is
+ */
+void post_turn(SharedLink* link, int id) {
+    Mailbox* mailbox = &link->mailboxes[id];
+    mailbox->turnAt = link->head;
+    link->posted[id].turns++;
+    __atomic_store_n(&mailbox->turns, link->posted[id].turns,
+            __ATOMIC_RELEASE);
+    wake_player(link, id);
+}
+
+/**
+ * Posts that the game has ended early, which takes no room in the ring so
+ * it can be posted even when a player has stopped reading
+ * @param link the dealer's link
+ */
+void post_early_game_over(SharedLink* link) {
+    __atomic_store_n(&link->header->early, 1, __ATOMIC_RELEASE);
+    wake_players(link);
+}
+
+/**
+ * Takes a player's answer to its latest YT message, if it has answered
+ * @param link the dealer's link
+ * @param id the player
+ * @param site set to the site in the player's DO message
+ * @returns true iff the player has answered
+ */
+bool take_move(SharedLink* link, int id, int* site) {
+    Mailbox* mailbox = &link->mailboxes[id];
+    if (__atomic_load_n(&mailbox->moves, __ATOMIC_ACQUIRE)
+            != link->posted[id].turns) {
+        return false;
+    }
+    *site = mailbox->site;
+    return true;
+}
+
+/**
+ * Clears the notifications players have sent the dealer, once it has
+ * been woken by them
+ * @param link the dealer's link
+ */
+void clear_notifications(SharedLink* link) {
+    uint64_t count;
+    if (read(link->notifyFd, &count, sizeof(count)) < 0) {
+        return; // nothing to clear
+    }
+}
+
+/**
+ * Wakes the dealer if it's waiting on this player
+ * @param link the player's link
+ */
+void notify_dealer(SharedLink* link) {
+    uint64_t one = 1;
+    if (write(link->notifyFd, &one, sizeof(one)) < 0) {
+        return; // the dealer has been notified plenty already
+    }
+}
+
+/**
+ * Checks if the dealer has gone, which is when the pipe it wrote the path
+ * down (and hasn't written to since) hangs up
+ * @returns true iff the dealer has gone
+ */
+bool dealer_gone(void) {
+    struct pollfd input = {.fd = STDIN_FILENO, .events = POLLIN};
+    return poll(&input, 1, 0) != 0;
+}
+
+/**
+ * Starts a player reading from where the dealer attached it; called once
+ * the dealer has answered the player's acceptance
+ * @param link the player's link
+ */
+void catch_up_shared_link(SharedLink* link) {
+    Mailbox* mailbox = &link->mailboxes[link->id];
+    // the player hasn't read anything since it was attached, but the dealer
+    // may already have posted its first YT
+    link->consumed = __atomic_load_n(&mailbox->consumed, __ATOMIC_ACQUIRE);
+    link->turnsSeen = 0;
+}
+
+/**
+ * Gets the next message for a player from the region, in the order the
+ * dealer posted them, waiting for one if need be
+ * @param link the player's link
+ * @returns the message; if the dealer has gone error is set
+ */
+Message next_shared_message(SharedLink* link) {
+    SharedHeader* header = link->header;
+    Mailbox* mailbox = &link->mailboxes[link->id];
+    Message message;
+    message.numParams = 0;
+    message.eof = false;
+    message.error = false;
+    bool timedOut = false;
+    while (true) {
+        uint32_t wake = __atomic_load_n(&mailbox->wake, __ATOMIC_ACQUIRE);
+        uint64_t head = __atomic_load_n(&header->head, __ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&mailbox->turns, __ATOMIC_ACQUIRE)
+                != link->turnsSeen && link->consumed >= mailbox->turnAt) {
+            // every event published before the YT has been read
+            link->turnsSeen++;
+            message.messageType = YT;
+            return message;
+        }
+        if (link->consumed < head) {
+            SharedEvent* slot = &link->events[link->consumed
+                    % SHARED_RING_SIZE];
+            message.messageType = slot->messageType;
+            message.numParams = (slot->messageType == HAP)
+                    ? NUM_HAP_PARAMS : 0;
+            memcpy(message.params, slot->params, sizeof(slot->params));
+            link->consumed++;
+            __atomic_store_n(&mailbox->consumed, link->consumed,
+                    __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&header->spaceWanted, __ATOMIC_SEQ_CST)) {
+                notify_dealer(link);
+            }
+            return message;
+        }
+        if (__atomic_load_n(&header->early, __ATOMIC_ACQUIRE)) {
+            message.messageType = EARLY;
+            return message;
+        }
+        // the dealer can't post anything if it has died, so it's checked
+        // on now and then; only once the region has been checked again,
+        // as the dealer writes down the pipe after posting DONE
+        if (timedOut && dealer_gone()) {
+            message.error = true;
+            return message;
+        }
+        struct timespec timeout = {.tv_sec = 0,
+                .tv_nsec = SHARED_POLL_MS * 1000000L};
+        __atomic_store_n(&mailbox->sleeping, 1, __ATOMIC_SEQ_CST);
+        long slept = syscall(SYS_futex, &mailbox->wake, FUTEX_WAIT, wake,
+                &timeout, NULL, 0);
+        __atomic_store_n(&mailbox->sleeping, 0, __ATOMIC_SEQ_CST);
+        timedOut = (slept == -1 && errno == ETIMEDOUT);
+    }
+}
+
+/**
+ * Answers the player's latest YT message with a DO message
+ * @param link the player's link
+ * @param site the site the player wants to move to
+ */
+void post_move(SharedLink* link, int site) {
+    Mailbox* mailbox = &link->mailboxes[link->id];
+    mailbox->site = site;
+    __atomic_store_n(&mailbox->moves, link->turnsSeen, __ATOMIC_RELEASE);
+    notify_dealer(link);
+}
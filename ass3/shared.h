@@ -0,0 +1,83 @@
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/futex.h>
+#include "message.h"
+#include "utility.h"
+#include "constants.h"
+
+typedef struct {
+    int32_t messageType; // HAP or DONE; EARLY isn't put in the ring
+    int32_t params[NUM_HAP_PARAMS]; // the params of the message
+} SharedEvent;
+
+typedef struct __attribute__((aligned(64))) {
+    uint32_t wake; // futex word the player sleeps on, bumped by the dealer
+    uint32_t sleeping; // set by the player while it's asleep on wake
+    uint32_t turns; // the number of YT messages posted to the player
+    uint32_t moves; // the number of DO messages the player has answered with
+    int32_t site; // the site in the player's latest DO message
+    uint64_t turnAt; // the number of events published before the latest YT
+    uint64_t consumed; // the number of events the player has read
+} Mailbox;
+
+typedef struct __attribute__((aligned(64))) {
+    uint32_t spaceWanted; // set while the dealer waits for room in the ring
+    uint32_t early; // set once the game has ended early
+    uint64_t head; // the number of events published
+} SharedHeader;
+
+// what the dealer has posted to a mailbox; players can write anywhere in
+// the region, so the dealer keeps its own copy rather than reading it back
+typedef struct {
+    bool attached; // the player uses the region
+    uint32_t turns; // the number of YT messages posted to the player
+} PostedMail;
+
+typedef struct {
+    SharedHeader* header; // the start of the region
+    Mailbox* mailboxes; // one per player, after the header
+    SharedEvent* events; // the ring of SHARED_RING_SIZE events, after those
+    size_t size; // the number of bytes mapped
+    int numPlayers; // the number of mailboxes, worked out from the size
+    int memoryFd; // the memfd holding the region
+    int notifyFd; // eventfd players write to when the dealer may want them
+    int id; // the player this process is, -1 for the dealer
+    uint64_t consumed; // (players) the number of events read
+    uint32_t turnsSeen; // (players) the number of YT messages read
+    uint64_t head; // (dealer) the number of events published
+    uint64_t oldest; // (dealer) fewest events any player had read, last look
+    PostedMail* posted; // (dealer) what it has posted to each mailbox
+} SharedLink;
+
+SharedLink* create_shared_link(int numPlayers);
+SharedLink* join_shared_link(char* description, int id);
+void free_shared_link(SharedLink* link);
+char* describe_shared_link(SharedLink* link);
+void attach_shared_player(SharedLink* link, int id);
+void detach_shared_player(SharedLink* link, int id);
+bool uses_shared_link(SharedLink* link, int id);
+bool publish_event(SharedLink* link, Message* event);
+void post_turn(SharedLink* link, int id);
+void post_early_game_over(SharedLink* link);
+bool take_move(SharedLink* link, int id, int* site);
+void clear_notifications(SharedLink* link);
+void catch_up_shared_link(SharedLink* link);
+Message next_shared_message(SharedLink* link);
+void post_move(SharedLink* link, int site);
+
+#endif
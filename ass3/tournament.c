@@ -0,0 +1,461 @@
+#define _GNU_SOURCE // for pipe2
+#include "tournament.h"
+
+extern char** environ;
+
+// private functions
+void usage_error(void);
+char** split_list(char* list, int* count);
+char* find_dealer(char* program);
+int choose_workers(int numMatches);
+void init_tournament(Tournament* tournament, int argc, char** argv);
+void* run_worker(void* arg);
+void play_match(Tournament* tournament, Match* match);
+char* read_output(int fd);
+void parse_scores(Match* match, char* output, int numPlayers);
+double seconds_since(struct timespec* start);
+int report(Tournament* tournament, int workers, double seconds);
+Standing* find_standing(Standing* standings, int* numStandings,
+        char* program);
+void add_score(Standing* standing, int score);
+int compare_scores(const void* first, const void* second);
+void print_standing(Standing* standing);
+void free_tournament(Tournament* tournament);
+
+/**
+ * Plays every lineup on every path with every deck, several games at once,
+ * and reports how each player program did
+ * @param argc the number of arguments
+ * @param argv paths, decks, then one or more lineups; each is a list
+ * separated by commas
+ * @returns TOURNAMENT_OK, or MATCHES_FAILED if a dealer didn't finish
+ */
+int main(int argc, char** argv) {
+    Tournament tournament;
+    init_tournament(&tournament, argc, argv);
+    int workers = choose_workers(tournament.numMatches);
+    // set before any threads start; the dealers inherit it
+    setenv(DEALER_OUTPUT_VARIABLE, "quiet", 1);
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t* threads = malloc(sizeof(pthread_t) * workers);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[i], NULL, run_worker, &tournament) != 0) {
+            fprintf(stderr, "Error starting worker\n");
+            exit(BAD_TOURNAMENT_START);
+        }
+    }
+    for (int i = 0; i < workers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    double seconds = seconds_since(&start);
+    free(threads);
+    int result = report(&tournament, workers, seconds);
+    free_tournament(&tournament);
+    return result;
+}
+
+/**
+ * Prints how the tournament should be run and exits
+ */
+void usage_error(void) {
+    fprintf(stderr, "Usage: 2310tournament path{,path} deck{,deck} "
+            "player{,player} {player{,player}}\n");
+    exit(BAD_TOURNAMENT_ARGS);
+}
+
+/**
+ * Splits a list separated by commas, in place
+ * @param list the list; its commas are replaced by null terminators
+ * @param count set to the number of entries in the list
+ * @returns the entries, NULL terminated, which must be freed
+ */
+char** split_list(char* list, int* count) {
+    *count = 1;
+    for (char* c = list; *c != '\0'; c++) {
+        *count += (*c == LIST_SEPARATOR);
+    }
+    char** entries = malloc(sizeof(char*) * (*count + 1));
+    for (int i = 0; i < *count; i++) {
+        entries[i] = list;
+        char* separator = strchr(list, LIST_SEPARATOR);
+        if (separator != NULL) {
+            *separator = '\0';
+            list = separator + 1;
+        }
+        if (entries[i][0] == '\0') {
+            usage_error(); // an empty entry
+        }
+    }
+    entries[*count] = NULL;
+    return entries;
+}
+
+/**
+ * Works out which dealer to run
+ * @param program how this program was run, i.e. argv[0]
+ * @returns the dealer program, which must be freed
+ */
+char* find_dealer(char* program) {
+    char* dealer = getenv(DEALER_VARIABLE);
+    if (dealer != NULL) {
+        return strdup(dealer);
+    }
+    char* slash = strrchr(program, '/');
+    if (slash == NULL) {
+        return strdup(DEALER_PROGRAM); // found on the PATH, like we were
+    }
+    int directoryLength = slash - program + 1; // + 1 keeps the '/'
+    dealer = malloc(sizeof(char)
+            * (directoryLength + strlen(DEALER_PROGRAM) + 1));
+    memcpy(dealer, program, directoryLength);
+    strcpy(dealer + directoryLength, DEALER_PROGRAM);
+    return dealer;
+}
+
+/**
+ * Decides how many games to run at once
+ * @param numMatches the number of matches to be played
+ * @returns the number of workers; one per core unless asked otherwise,
+ * and never more than there are matches
+ */
+int choose_workers(int numMatches) {
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    char* requested = getenv(WORKERS_VARIABLE);
+    if (requested != NULL) {
+        char* end;
+        workers = strtol(requested, &end, 10);
+        if (*end != '\0' || workers < 1) {
+            usage_error();
+        }
+    }
+    if (workers < 1) {
+        workers = 1; // the core count wasn't available
+    }
+    return workers < numMatches ? workers : numMatches;
+}
+
+/**
+ * Sets up the tournament from its arguments: a match for every
+ * combination of path, deck and lineup
+ * @param tournament the tournament to set up
+ * @param argc the number of arguments
+ * @param argv the arguments
+ */
+void init_tournament(Tournament* tournament, int argc, char** argv) {
+    if (argc < 4) {
+        usage_error();
+    }
+    int numPaths;
+    int numDecks;
+    char** paths = split_list(argv[1], &numPaths);
+    char** decks = split_list(argv[2], &numDecks);
+    int numLineups = argc - 3;
+    tournament->numLineups = numLineups;
+    tournament->lineups = malloc(sizeof(char**) * numLineups);
+    tournament->lineupSizes = malloc(sizeof(int) * numLineups);
+    for (int i = 0; i < numLineups; i++) {
+        tournament->lineups[i] = split_list(argv[i + 3],
+                &tournament->lineupSizes[i]);
+    }
+    tournament->dealer = find_dealer(argv[0]);
+    tournament->numMatches = numPaths * numDecks * numLineups;
+    tournament->matches = malloc(sizeof(Match) * tournament->numMatches);
+    Match* match = tournament->matches;
+    for (int i = 0; i < numPaths; i++) {
+        for (int j = 0; j < numDecks; j++) {
+            for (int k = 0; k < numLineups; k++) {
+                match->path = paths[i];
+                match->deck = decks[j];
+                match->lineup = k;
+                match->status = -1;
+                match->numGames = 0;
+                match->scores = NULL;
+                match++;
+            }
+        }
+    }
+    free(paths); // the entries themselves are in argv
+    free(decks);
+    tournament->nextMatch = 0;
+    pthread_mutex_init(&tournament->lock, NULL);
+}
+
+/**
+ * Plays matches until there are none left to take
+ * @param arg the tournament
+ * @returns NULL
+ */
+void* run_worker(void* arg) {
+    Tournament* tournament = arg;
+    while (true) {
+        pthread_mutex_lock(&tournament->lock);
+        int next = tournament->nextMatch++;
+        pthread_mutex_unlock(&tournament->lock);
+        if (next >= tournament->numMatches) {
+            return NULL;
+        }
+        play_match(tournament, &tournament->matches[next]);
+    }
+}
+
+/**
+ * Runs the dealer for a match and records the scores it prints
+ * @param tournament the tournament
+ * @param match the match to play
+ */
+void play_match(Tournament* tournament, Match* match) {
+    char** players = tournament->lineups[match->lineup];
+    int numPlayers = tournament->lineupSizes[match->lineup];
+    // dealer deck path p1 {p2}, then NULL
+    char** args = malloc(sizeof(char*) * (numPlayers + 4));
+    args[0] = tournament->dealer;
+    args[1] = match->deck;
+    args[2] = match->path;
+    memcpy(args + 3, players, sizeof(char*) * (numPlayers + 1));
+    // close-on-exec, so other workers' dealers don't hold it open
+    int fds[2];
+    if (pipe2(fds, O_CLOEXEC) == -1) {
+        free(args);
+        return;
+    }
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+            O_WRONLY, 0);
+    pid_t pid;
+    bool started = posix_spawnp(&pid, tournament->dealer, &actions, NULL,
+            args, environ) == 0;
+    posix_spawn_file_actions_destroy(&actions);
+    free(args);
+    close(fds[1]);
+    char* output = read_output(fds[0]);
+    close(fds[0]);
+    int status;
+    if (started && waitpid(pid, &status, 0) == pid && WIFEXITED(status)) {
+        match->status = WEXITSTATUS(status);
+    }
+    parse_scores(match, output, numPlayers);
+    free(output);
+}
+
+/**
+ * Reads everything a dealer writes to its stdout
+ * @param fd the read end of the dealer's stdout
+ * @returns the output, null terminated, which must be freed
+ */
+char* read_output(int fd) {
+    size_t capacity = OUTPUT_BUFFER_SIZE;
+    size_t length = 0;
+    char* output = malloc(sizeof(char) * capacity);
+    ssize_t got;
+    while ((got = read(fd, output + length, capacity - length - 1)) != 0) {
+        if (got == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        length += got;
+        if (length == capacity - 1) {
+            capacity *= 2;
+            output = realloc(output, sizeof(char) * capacity);
+        }
+    }
+    output[length] = '\0';
+    return output;
+}
+
+/**
+ * Finds the scores of each game in a dealer's output. The dealer prints a
+ * line of them after each game (several if DEALER_GAMES is set).
+ * @param match the match the output is from
+ * @param output the dealer's stdout
+ * @param numPlayers the number of players in the match
+ */
+void parse_scores(Match* match, char* output, int numPlayers) {
+    size_t prefixLength = strlen(SCORES_PREFIX);
+    for (char* line = output; line != NULL && *line != '\0';
+            line = strchr(line, '\n') ? strchr(line, '\n') + 1 : NULL) {
+        if (strncmp(line, SCORES_PREFIX, prefixLength) != 0) {
+            continue;
+        }
+        match->scores = realloc(match->scores,
+                sizeof(int) * numPlayers * (match->numGames + 1));
+        int* scores = match->scores + numPlayers * match->numGames;
+        char* field = line + prefixLength;
+        for (int i = 0; i < numPlayers; i++) {
+            char* end;
+            scores[i] = strtol(field, &end, 10);
+            char expected = (i == numPlayers - 1) ? '\n' : ',';
+            if (end == field || *end != expected) {
+                return; // cut short, so the game didn't finish
+            }
+            field = end + 1;
+        }
+        match->numGames++;
+    }
+}
+
+/**
+ * Works out how long it's been since a time
+ * @param start the time
+ * @returns the seconds since start
+ */
+double seconds_since(struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec)
+            + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/**
+ * Prints how each player program did across the tournament's games, the
+ * matches which failed, and how quickly the games were played
+ * @param tournament the tournament, with its matches played
+ * @param workers the number of games that were run at once
+ * @param seconds how long the matches took
+ * @returns TOURNAMENT_OK, or MATCHES_FAILED if a dealer didn't finish
+ */
+int report(Tournament* tournament, int workers, double seconds) {
+    // there can't be more programs than seats in all the lineups
+    int maxStandings = 0;
+    for (int i = 0; i < tournament->numMatches; i++) {
+        maxStandings += tournament->lineupSizes[tournament->matches[i].lineup];
+    }
+    Standing* standings = malloc(sizeof(Standing) * maxStandings);
+    int numStandings = 0;
+    int numGames = 0;
+    int numFailed = 0;
+    for (int i = 0; i < tournament->numMatches; i++) {
+        Match* match = &tournament->matches[i];
+        char** players = tournament->lineups[match->lineup];
+        int numPlayers = tournament->lineupSizes[match->lineup];
+        if (match->status != 0) {
+            numFailed++;
+            fprintf(stderr, "Failed: %s %s lineup %d (status %d)\n",
+                    match->path, match->deck, match->lineup + 1,
+                    match->status);
+            continue;
+        }
+        for (int game = 0; game < match->numGames; game++) {
+            int* scores = match->scores + game * numPlayers;
+            int best = scores[0];
+            int numWinners = 0;
+            for (int j = 0; j < numPlayers; j++) {
+                best = scores[j] > best ? scores[j] : best;
+            }
+            for (int j = 0; j < numPlayers; j++) {
+                numWinners += (scores[j] == best);
+            }
+            for (int j = 0; j < numPlayers; j++) {
+                Standing* standing = find_standing(standings, &numStandings,
+                        players[j]);
+                add_score(standing, scores[j]);
+                if (scores[j] == best) {
+                    standing->wins += 1.0 / numWinners;
+                }
+            }
+        }
+        numGames += match->numGames;
+    }
+    printf("Matches: %d played, %d failed\n",
+            tournament->numMatches - numFailed, numFailed);
+    printf("Games: %d in %.2fs with %d workers (%.1f games/s)\n", numGames,
+            seconds, workers, seconds > 0 ? numGames / seconds : 0.0);
+    printf("%-20s %6s %8s %6s %7s %5s %5s %6s %5s %5s\n", "Program", "Seats",
+            "Wins", "Win%", "Mean", "Min", "Q1", "Median", "Q3", "Max");
+    for (int i = 0; i < numStandings; i++) {
+        print_standing(&standings[i]);
+        free(standings[i].scores);
+    }
+    free(standings);
+    return numFailed > 0 ? MATCHES_FAILED : TOURNAMENT_OK;
+}
+
+/**
+ * Finds a player program's standing, adding it if it has none yet
+ * @param standings the standings so far
+ * @param numStandings the number of standings, updated if one is added
+ * @param program the player program
+ * @returns the program's standing
+ */
+Standing* find_standing(Standing* standings, int* numStandings,
+        char* program) {
+    for (int i = 0; i < *numStandings; i++) {
+        if (strcmp(standings[i].program, program) == 0) {
+            return &standings[i];
+        }
+    }
+    Standing* standing = &standings[(*numStandings)++];
+    standing->program = program;
+    standing->seats = 0;
+    standing->wins = 0;
+    standing->capacity = INITIAL_SCORES;
+    standing->scores = malloc(sizeof(int) * standing->capacity);
+    return standing;
+}
+
+/**
+ * Records a player program's score in a game
+ * @param standing the program's standing
+ * @param score its score
+ */
+void add_score(Standing* standing, int score) {
+    if (standing->seats == standing->capacity) {
+        standing->capacity *= 2;
+        standing->scores = realloc(standing->scores,
+                sizeof(int) * standing->capacity);
+    }
+    standing->scores[standing->seats++] = score;
+}
+
+/**
+ * Orders scores from lowest to highest, for qsort
+ * @param first pointer to a score
+ * @param second pointer to another score
+ * @returns negative, zero or positive as first is below, at or above second
+ */
+int compare_scores(const void* first, const void* second) {
+    int a = *(const int*) first;
+    int b = *(const int*) second;
+    return (a > b) - (a < b);
+}
+
+/**
+ * Prints a row of the results table for a player program
+ * @param standing the program's standing; its scores get sorted
+ */
+void print_standing(Standing* standing) {
+    int seats = standing->seats;
+    int* scores = standing->scores;
+    qsort(scores, seats, sizeof(int), compare_scores);
+    double total = 0;
+    for (int i = 0; i < seats; i++) {
+        total += scores[i];
+    }
+    printf("%-20s %6d %8.1f %6.1f %7.2f %5d %5d %6d %5d %5d\n",
+            standing->program, seats, standing->wins,
+            100 * standing->wins / seats, total / seats, scores[0],
+            scores[seats / 4], scores[seats / 2], scores[seats * 3 / 4],
+            scores[seats - 1]);
+}
+
+/**
+ * Frees everything the tournament allocated
+ * @param tournament the tournament
+ */
+void free_tournament(Tournament* tournament) {
+    for (int i = 0; i < tournament->numMatches; i++) {
+        free(tournament->matches[i].scores);
+    }
+    free(tournament->matches);
+    for (int i = 0; i < tournament->numLineups; i++) {
+        free(tournament->lineups[i]); // the programs themselves are in argv
+    }
+    free(tournament->lineups);
+    free(tournament->lineupSizes);
+    free(tournament->dealer);
+    pthread_mutex_destroy(&tournament->lock);
+}
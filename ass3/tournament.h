@@ -0,0 +1,64 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+// how many games run at once, unset for one per core
+#define WORKERS_VARIABLE "TOURNAMENT_WORKERS"
+// the dealer to run, unset for the 2310dealer beside this program
+#define DEALER_VARIABLE "TOURNAMENT_DEALER"
+// the dealer's output mode; only the scores are wanted
+#define DEALER_OUTPUT_VARIABLE "DEALER_OUTPUT"
+#define DEALER_PROGRAM "2310dealer" // the dealer's name
+#define SCORES_PREFIX "Scores: " // starts the line with a game's scores
+#define LIST_SEPARATOR ',' // separates the files or programs in a list
+#define OUTPUT_BUFFER_SIZE 256 // the initial size of a match's output buffer
+#define INITIAL_SCORES 64 // the initial room for a program's scores
+
+typedef enum {
+    TOURNAMENT_OK = 0, // every match was played
+    BAD_TOURNAMENT_ARGS = 1, // the tournament was started with bad args
+    BAD_TOURNAMENT_START = 2, // a worker thread couldn't be started
+    MATCHES_FAILED = 3 // at least one dealer didn't finish its games
+} TournamentErr;
+
+typedef struct {
+    char* path; // the path file
+    char* deck; // the deck file
+    int lineup; // which lineup plays
+    int status; // the dealer's exit status, -1 if it didn't exit or start
+    int numGames; // the number of games' scores the dealer printed
+    int* scores; // each game's scores, one per player, in order
+} Match;
+
+typedef struct {
+    char*** lineups; // the player programs in each lineup, NULL terminated
+    int* lineupSizes; // the number of players in each lineup
+    int numLineups; // the number of lineups
+    char* dealer; // the dealer program
+    Match* matches; // every path, deck and lineup combination
+    int numMatches; // the number of matches
+    int nextMatch; // the first match no worker has taken
+    pthread_mutex_t lock; // guards nextMatch
+} Tournament;
+
+typedef struct {
+    char* program; // the player program
+    int seats; // the number of times it's played a game
+    double wins; // the games it won, ties shared between the winners
+    int* scores; // its score in each of those games
+    int capacity; // the number of scores there is room for
+} Standing;
+
+#endif
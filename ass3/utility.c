@@ -2,8 +2,8 @@
 
 // private functions
 bool cards_left(Player* player, int* cards);
-char* site_to_string(Site site);
-int get_num_levels(Game game);
+char* site_to_string(SiteType type);
+bool is_discarded(FILE* stream);
 
 /**
  * Safely converts a String (reprenting a non-negative number) to an int
@@ -49,31 +49,6 @@ int num_digits(int number) {
     return digits;
 }
 
-/**
-* Gets a line from stream. A line is terminated at either '\n' or EOF.
-* @param stream the stream to retrieve the line from
-* @param eof sets this bool to true iff EOF was encountered when getting line
-* @returns Returns line from stream (without the '\n' or EOF) as a null
-* terminated char*.
-*/
-char* get_line(FILE* stream, bool* eof) {
-    char* str = malloc(sizeof(char));
-    int c;
-    int i = 0;
-    while((c = fgetc(stream)) != EOF) {
-        str[i] = c;
-        i++;
-        str = realloc(str, sizeof(char) * (i + 1)); // incredibly inefficient
-        if (c == '\n') {
-            str[i] = '\0';
-            break;
-        }
-    }
-    str[i] = '\0';
-    *eof = (c == EOF);
-    return str;
-}
-
 /**
  * Determines whether the card is valid 
  * i.e. between A and E
@@ -164,27 +139,53 @@ void print_player_info(FILE* stream, Player* p) {
 }
 
 /**
- * Prints the game path to specified stream
+ * Prints a move in one line: the player's info, with where they now are
+ * @param stream the stream to print the line to
+ * @param p pointer to the player who moved
+ */
+void print_player_event(FILE* stream, Player* p) {
+    fprintf(stream, "Player %d Site=%d Money=%d V1=%d V2=%d "
+            "Points=%d A=%d B=%d C=%d D=%d E=%d\n",
+            p->playerId, p->site, p->money, p->v1, p->v2, p->points,
+            p->cards[A], p->cards[B], p->cards[C], p->cards[D], p->cards[E]);
+    fflush(stream);
+}
+
+/**
+ * Prints the game path to specified stream. The path is drawn in memory
+ * and written in one go.
  * @param game the main game struct
  * @param stream the stream for the path to be printed to
  */
 void print_path(Game game, FILE* stream) {
-    for (int i = 0; i < game.path.size; i++) {
-        fprintf(stream, "%s ", site_to_string(game.path.sites[i]));
+    int size = game.path.size;
+    // a player's cell is their id and two spaces; an empty one, 3 spaces
+    size_t cellWidth = num_digits(game.numPlayers - 1) + 2;
+    size_t length = (size_t) size * CHARS_PER_SITE
+            + game.numLevels * (1 + size * cellWidth) + 1;
+    char* text = malloc(sizeof(char) * (length + 1)); // + 1 for sprintf's \0
+    char* end = text;
+    for (int i = 0; i < size; i++) {
+        memcpy(end, site_to_string(game.path.types[i]), 2);
+        end[2] = ' ';
+        end += CHARS_PER_SITE;
     }
-    for (int i = 0; i < get_num_levels(game); i++) {
-        fprintf(stream, "\n"); // stop printing new lines when no players
-        for (int j = 0; j < game.path.size; j++) {
-            if (game.path.sites[j].numPlayers > i) {
-                fprintf(stream, "%d  ", game.path.sites[j].playerIds[i]);
+    for (int i = 0; i < game.numLevels; i++) {
+        *end++ = '\n'; // stop printing new lines when no players
+        for (int j = 0; j < size; j++) {
+            if (game.path.occupancy[j] > i) {
+                end += sprintf(end, "%d  ",
+                        game.path.playerIds[game.path.firstSlot[j] + i]);
             } else {
-                fprintf(stream, "   ");
+                memcpy(end, "   ", 3);
+                end += 3;
             }
         }
     }
-    fprintf(stream, "\n");
+    *end++ = '\n';
+    fwrite(text, sizeof(char), end - text, stream);
     fflush(stream);
-    return;
+    free(text);
 }
 
 /**
@@ -207,12 +208,12 @@ void print_scores(Game* game, FILE* stream) {
 
 /**
  * Converts site type to the string that represents it
- * @param site the site struct
+ * @param type the type of the site
  * @returns string representation of the site
  */
-char* site_to_string(Site site) {
+char* site_to_string(SiteType type) {
     char* siteString = ""; // string version of site
-    switch(site.type) {
+    switch(type) {
         case MO_SITE:
             siteString = "Mo";
             break;
@@ -236,24 +237,65 @@ char* site_to_string(Site site) {
 }
 
 /**
- * Counts the number of levels that need to be printed when the path is printed
- * @param game the main game struct
- * @returns the number of levels that need to be printed
+ * Decides how much of the game to show on a stream. The environment
+ * variable can be "full", "events" or "quiet"; otherwise nothing is shown
+ * if the stream goes to /dev/null, and everything is if it doesn't.
+ * @param stream the stream the game is shown on
+ * @param variable the environment variable which can choose the mode
+ * @returns the output mode to use
  */
-int get_num_levels(Game game) {
-    bool empty;
-    for (int i = 0; i < game.numPlayers; i++) {
-        empty = true;
-        for (int j = 0; j < game.path.size; j++) {
-            if (game.path.sites[j].numPlayers > i) {
-                empty = false;
-            }            
-        }
-        if (empty) {
-            return i;
+OutputMode choose_output_mode(FILE* stream, char* variable) {
+    char* mode = getenv(variable);
+    if (mode != NULL) {
+        if (strcmp(mode, "full") == 0) {
+            return FULL_OUTPUT;
+        } else if (strcmp(mode, "events") == 0) {
+            return EVENT_OUTPUT;
+        } else if (strcmp(mode, "quiet") == 0) {
+            return QUIET_OUTPUT;
         }
     }
-    return game.numPlayers;
+    return is_discarded(stream) ? QUIET_OUTPUT : FULL_OUTPUT;
+}
+
+/**
+ * Checks whether a stream is going to /dev/null
+ * @param stream the stream
+ * @returns true iff anything written to stream is thrown away
+ */
+bool is_discarded(FILE* stream) {
+    struct stat streamInfo;
+    struct stat nullInfo;
+    return fstat(fileno(stream), &streamInfo) == 0
+            && stat("/dev/null", &nullInfo) == 0
+            && S_ISCHR(streamInfo.st_mode)
+            && streamInfo.st_rdev == nullInfo.st_rdev;
+}
+
+/**
+ * Shows a player who has just moved, as much as the output mode asks for
+ * @param stream the stream to show the player on
+ * @param mode the output mode
+ * @param player pointer to the player
+ */
+void show_player(FILE* stream, OutputMode mode, Player* player) {
+    if (mode == FULL_OUTPUT) {
+        print_player_info(stream, player);
+    } else if (mode == EVENT_OUTPUT) {
+        print_player_event(stream, player);
+    }
+}
+
+/**
+ * Shows the path, if the output mode shows everything
+ * @param stream the stream to show the path on
+ * @param mode the output mode
+ * @param game pointer to the main game struct
+ */
+void show_path(FILE* stream, OutputMode mode, Game* game) {
+    if (mode == FULL_OUTPUT) {
+        print_path(*game, stream);
+    }
 }
 
 /**
@@ -290,12 +332,8 @@ bool is_valid_hap(Message message, Game game) {
  * @param game main game struct
  */
 void free_game(Game game) {
-    for (int i = 0; i < game.numPlayers; i++) {
-        free(game.players[i].cards);
-    }
     free(game.players);    
-    for (int i = 0; i < game.path.size; i++) {
-        free(game.path.sites[i].playerIds);
-    }
-    free(game.path.sites);
+    free(game.path.types); // the start of all the path's arrays
+    free(game.coords);
+    free(game.levelSites);
 }
\ No newline at end of file
@@ -5,22 +5,32 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <sys/stat.h>
 #include "game.h"
 #include "message.h"
 #include "constants.h"
 
+typedef enum {
+    QUIET_OUTPUT = 0, // nothing but the scores
+    EVENT_OUTPUT = 1, // a line for each move
+    FULL_OUTPUT = 2 // the player's info and the whole path for each move
+} OutputMode;
+
 int string_to_int(char* string, int* error);
 char* int_to_string(int number);
 int num_digits(int number);
-char* get_line(FILE* stream, bool* eof);
 int calculate_points_from_cards(Player* player);
 int calculate_points_from_sites(Player* player);
 void free_game(Game game);
 bool is_valid_card(char card);
 bool is_valid_hap(Message message, Game game);
 void print_player_info(FILE* stream, Player* player);
+void print_player_event(FILE* stream, Player* player);
 void print_path(Game game, FILE* stream);
 void print_scores(Game* game, FILE* stream);
+OutputMode choose_output_mode(FILE* stream, char* variable);
+void show_player(FILE* stream, OutputMode mode, Player* player);
+void show_path(FILE* stream, OutputMode mode, Game* game);
 
 
 #endif
\ No newline at end of file